@@ -17,14 +17,22 @@
  *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-#include <iostream>
-#include <iomanip>
-#include <vector>
 #include <list>
 #include <set>
+#include <cstring>
+#include <cerrno>
 #include <gtk/gtk.h>
-#include "Digraph.h"
-#include "BTree-dd.tcc"
+#include "Daily.h"
+#include "Puzzle.h"
+#include "Journal.h"
+#include "Solver.h"
+#include "Validate.h"
+#include "Zobrist.h"
+#include "Hint.h"
+#include "Monitor.h"
+#include "StepTrace.h"
+#include "Log.h"
+#include "Trace.h"
 #include "common.h"
 #include "Callback.h"
 #include "../test/Test.h"
@@ -36,6 +44,14 @@ typedef struct shape_info_st {
 	bool operator< (const struct shape_info_st& ref) const;
 } shape_info_t;
 
+// Read-only view over cells of the board, without copying them
+typedef struct cell_view_st {
+	const shape_info_t *first;
+	int stride;		// 1 for rows and the whole board, 6 for columns
+	int size;
+	const shape_info_t& operator[] (int n) const { return first[n * stride]; }
+} cell_view_t;
+
 bool shape_info_t::operator< (const shape_info_t& ref) const
 {
 	if (this->ncell < ref.ncell)
@@ -60,18 +76,32 @@ public:
 
 	Board ();
 	Board (bool testing, std::string test_filename);
+	explicit Board (const puzzle_rec_t *rec);
 	Board (Board&) = delete;
 	Board (Board&&) = delete;
 	Board& operator= (Board&) = delete;
 	~Board ();
 
 	void new_game ();
+	void new_daily_game ();
+	void generate (int seed);
+	void play_puzzle (const puzzle_rec_t *rec);
+	void load_puzzle (const puzzle_rec_t *rec);
+	void save_puzzle (puzzle_rec_t *rec) const;
+	void restore_guess (uint64_t filled, uint64_t moons);
+	void journal_move (journal_type_t type, int ncell);
+	bool apply_journal_move (const journal_rec_t *rec);
+	bool replay_journal (const journal_t *j, uint32_t nmoves);
 	void set_seed (int seed);
+	void set_givens (int count, bool unique);
 	void draw_shape (int nrow, int ncol, shape_t shape);
 	void draw_cells (cairo_t *cr);
-	bool can_draw_hatching (int ncell);
+	bool can_draw_hatching (int ncell) const;
 	void set_hatching (int ncell, bool hor);
 	void clear_hatching (int ncell, bool hor);
+	void set_hatching_mask (uint64_t mask, bool hor);
+	void clear_hatching_mask (uint64_t mask, bool hor);
+	uint64_t get_hatching () const;
 	void draw_hatching (int ncell);
 	void draw_hatching_on_immutable ();
 	bool get_game_over ();
@@ -83,6 +113,13 @@ public:
 	shape_info_t get_shape_status (int ncell) const;
 	shape_info_t get_user_guess (int ncell) const;
 	shape_info_t get_standard_solution (int ncell) const;
+	shape_t get_user_shape (int ncell) const;
+	shape_t get_solution_shape (int ncell) const;
+	const shape_info_t& view_user_guess (int ncell) const;
+	const shape_info_t& view_standard_solution (int ncell) const;
+	cell_view_t view_row (int nrow, bool std) const;
+	cell_view_t view_col (int ncol, bool std) const;
+	cell_view_t view_board (bool std) const;
 	void set_shape_status (int ncell, shape_t sh);
 	void set_user_guess (int ncell, shape_t sh, bm_flags_t flags);
 	int get_num_hsuns (int row, bool std);
@@ -91,20 +128,25 @@ public:
 	int get_num_vmoons (int col, bool std);
 	int get_third_adjacent (int row, int col, line_type_check check, bool std);
 	int is_valid (int *row, int *col, int *nsuns, int *nmoons, bool std);
-
-	void validate_row_three_adjs (int nrow);
-	void validate_row_diff_num_of_shapes (int nrow);
-	void validate_row_constraints (int nrow);
 	void validate_row (int nrow);
-	void validate_col_three_adjs (int ncol);
-	void validate_col_diff_num_of_shapes (int ncol);
-	void validate_col_constraints (int ncol);
 	void validate_col (int ncol);
+	uint64_t get_conflicts (int rule) const;
 
 	void prepare ();
 	void print (bool is_testing, bool display_values, int n_step);
-	std::string get_debug (int n_step, int row, int col) const;
 	bool is_immutable (int n) const;
+	uint64_t get_immutable () const;
+	uint64_t get_filled () const;
+	int get_num_filled () const;
+	uint64_t get_moons () const;
+	uint64_t get_user_hash () const;
+	uint64_t get_solution_hash () const;
+	bool can_be_completed () const;
+	hint_t next_hint ();
+	hint_t get_hint () const;
+	void draw_hint ();
+	void check_completion ();
+	monitor_status_t get_completion () const;
 	void set_immutable_cells (int *imm);
 	void set_immutable_cells ();
 	void draw_immutable_cells ();
@@ -112,19 +154,44 @@ public:
 	void set_constraints (cons_t *cons);
 	void set_constraints ();
 	void draw_constraints ();
+	void render (cairo_t *cr, int width, int height);
 	bool is_configured () const;
 	bool is_testing () const;
 
 private:
+	void clear_cells ();
+	void restart ();
+	void add_immutable_cell (int n);
+	void make_unique ();
+	void rehash ();
+	uint64_t search_key (const puzzle_rec_t *rec) const;
+	void check_line (int line);
+	double get_x_scale () const;
+	double get_y_scale () const;
+
 	cairo_t *cr;
+	int surface_width;		// Size of the surface given to render (), 0 to draw on da
+	int surface_height;
 	shape_info_t standard_solution[6][6];
 	shape_info_t user_guess[6][6];
+	uint64_t hor_hatching;		// Cells of the user's guess hatched by row checks
+	uint64_t ver_hatching;		// ... and by column checks
+	uint8_t conflicts[VALIDATE_NUM_RULES][12];	// Cells of each line to blame, see check_line ()
+	uint64_t imm_mask;		// Immutable cells
+	uint64_t filled_mask;		// Cells of the user's guess holding a shape
+	uint64_t user_hash;		// Zobrist hash of the user's guess, see src/Zobrist.cc
+	uint64_t solution_hash;		// ... and of the standard solution
+	hint_lines_t hint_lines;	// Cells forced on each line, see src/Hint.cc
+	hint_t hint;			// Last hint given, until the next move
+	journal_writer_t *journal;	// Created on the first move, see journal_move ()
+	int64_t journal_t0;		// Monotonic time the game started at
 	bool configured;
 	bool testing;
 	std::string test_filename;
 	std::string exp_filename;
 	int seed;
-	std::string debug[0x40][6][6];
+	int ngivens;			// Immutable cells placed by set_immutable_cells ()
+	bool unique_givens;		// Add givens until there's a single solution
 	bool game_over;
 };
 
@@ -133,12 +200,26 @@ extern class Board board;
 // Default constructor for interactive gameplay (i.e., not for testing)
 Board::Board ()
 {
-	new_game ();
+	journal = nullptr;
+	surface_width = 0;
+	surface_height = 0;
+	ngivens = 6;
+	unique_givens = false;
+	new_daily_game ();
 }
 
 // Constructor overloaded for testing (`make check`)
 Board::Board (bool testing, std::string test_filename)
 {
+	journal = nullptr;
+	surface_width = 0;
+	surface_height = 0;
+	ngivens = 6;
+	unique_givens = false;
+	hor_hatching = 0;
+	ver_hatching = 0;
+	imm_mask = 0;
+	filled_mask = 0;
 	if (testing) {
 		this->testing = true;
 
@@ -170,23 +251,281 @@ Board::Board (bool testing, std::string test_filename)
 		}
 	}
 
+	// Fixtures carry their own solution, so they don't depend on prepare ()
+	for (int i = 0; i < 36; i++)
+		standard_solution[i / 6][i % 6].shape = ((test.get_input_parsed ()->solution >> i) & 1) ? SHAPE_MOON : SHAPE_SUN;
+	memset (&hint_lines, 0, sizeof (hint_lines));
+	memset (conflicts, 0, sizeof (conflicts));
+	hint.rule = HINT_NONE;
+	rehash ();
 	seed = test.get_input_parsed ()->seed;
 	srand (seed);
-	prepare ();
+}
+
+/*
+ * Constructor for command-line tools: it never touches the widgets, so the
+ * board can be generated, loaded or saved without a display
+ */
+Board::Board (const puzzle_rec_t *rec)
+{
+	this->testing = false;
+	this->configured = false;
+	this->game_over = false;
+	this->seed = 0;
+	this->journal = nullptr;
+	this->ngivens = 6;
+	this->unique_givens = false;
+	this->solution_hash = 0;
+	this->surface_width = 0;
+	this->surface_height = 0;
+	if (rec)
+		load_puzzle (rec);
+	else
+		clear_cells ();
 }
 
 Board::~Board ()
 {
+	journal_writer_close (journal);
 }
 
 void Board::new_game ()
 {
 	seed = time (nullptr);
-	std::cout << "seed = " << seed << std::endl;
+	LOG_PRINTF (LOG_LEVEL_INFO, "seed = %u", (unsigned) seed);
 	srand (seed);
 	prepare ();
-	game_over = false;
+	clear_cells ();
+	this->configured = false;
+	restart ();
+}
 
+/*
+ * The board of the day only depends on the calendar date and the salt given
+ * at configure time, so every player gets the same one. Since we don't want
+ * to pay for prepare () on every launch, generated boards are kept in an
+ * on-disk cache (see src/Daily.cc) and then restored straight from there
+ */
+void Board::new_daily_game ()
+{
+	int date, day;
+	const daily_entry_t *cached;
+	daily_entry_t entry;
+
+	date = daily_get_date (time (nullptr), &day);
+	daily_cache_evict (day, DAILY_CACHE_MAX_AGE);
+
+	if ((cached = daily_cache_lookup (date, day))) {
+		load_puzzle (&cached->puzzle);
+	} else {
+		seed = daily_get_seed (date, TANGORINEBA_DAILY_SALT);
+		LOG_PRINTF (LOG_LEVEL_INFO, "seed = %u", (unsigned) seed);
+		generate (seed);
+
+		memset (&entry, 0, sizeof (entry));
+		entry.date = date;
+		entry.day = day;
+		save_puzzle (&entry.puzzle);
+		entry.puzzle.date = date;
+		daily_cache_store (&entry);
+	}
+	this->configured = true;
+	restart ();
+}
+
+// Build a whole new board (solution, immutable cells and constraints) from @seed
+void Board::generate (int seed)
+{
+	this->seed = seed;
+	srand (seed);
+	clear_cells ();
+	prepare ();
+	set_immutable_cells ();
+	set_constraints ();
+	if (unique_givens)
+		make_unique ();
+	this->configured = true;
+}
+
+// Play a board taken from a pack file (see src/Puzzle.cc)
+void Board::play_puzzle (const puzzle_rec_t *rec)
+{
+	load_puzzle (rec);
+	restart ();
+}
+
+/*
+ * Rebuild the board from its binary record. Constraints are always attached
+ * to the right or bottom side of the first cell of the edge, no matter which
+ * side set_constraints () picked when the board was generated
+ */
+void Board::load_puzzle (const puzzle_rec_t *rec)
+{
+	int i, edge, cell_0, cell_1;
+	uint64_t m;
+
+	clear_cells ();
+	seed = rec->seed;
+	for (i = 0; i < 36; i++)
+		standard_solution[i / 6][i % 6].shape = ((rec->solution >> i) & 1) ? SHAPE_MOON : SHAPE_SUN;
+	for (m = rec->immutable; m; ) {
+		i = pop_cell (&m);
+		standard_solution[i / 6][i % 6].flags.imm = 1;
+		user_guess[i / 6][i % 6].flags.imm = 1;
+		user_guess[i / 6][i % 6].shape = standard_solution[i / 6][i % 6].shape;
+	}
+	imm_mask = rec->immutable;
+	filled_mask = rec->immutable;
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		shape_info_t& ref = standard_solution[cell_0 / 6][cell_0 % 6];
+		bool equal = ref.shape == standard_solution[cell_1 / 6][cell_1 % 6].shape;
+		if (edge < 30) {
+			ref.flags.right = 1;
+			ref.flags.right_equal = equal;
+		} else {
+			ref.flags.bottom = 1;
+			ref.flags.bottom_equal = equal;
+		}
+		user_guess[cell_0 / 6][cell_0 % 6].flags = ref.flags;
+	}
+	rehash ();
+	this->configured = true;
+}
+
+void Board::save_puzzle (puzzle_rec_t *rec) const
+{
+	int i, n;
+
+	puzzle_clear (rec);
+	rec->seed = seed;
+	rec->immutable = imm_mask;
+	for (i = 0, n = 0; i < 36; i++) {
+		const shape_info_t& ref = standard_solution[i / 6][i % 6];
+
+		if (ref.shape == SHAPE_MOON)
+			rec->solution |= (uint64_t) 1 << i;
+
+		// Flags pointing off the board, as on a border cell, have no edge to go to
+		if (ref.flags.top && i >= 6 && n < PUZZLE_MAX_CONS)
+			puzzle_set_edge (rec, n++, 30 + i - 6);
+		if (ref.flags.right && i % 6 < 5 && n < PUZZLE_MAX_CONS)
+			puzzle_set_edge (rec, n++, (i / 6) * 5 + i % 6);
+		if (ref.flags.bottom && i < 30 && n < PUZZLE_MAX_CONS)
+			puzzle_set_edge (rec, n++, 30 + i);
+		if (ref.flags.left && i % 6 > 0 && n < PUZZLE_MAX_CONS)
+			puzzle_set_edge (rec, n++, (i / 6) * 5 + i % 6 - 1);
+	}
+}
+
+// Replace the user's guess on every mutable cell by @filled and @moons
+void Board::restore_guess (uint64_t filled, uint64_t moons)
+{
+	int n;
+	uint64_t m;
+
+	for (m = ~imm_mask & (((uint64_t) 1 << 36) - 1); m; ) {
+		n = pop_cell (&m);
+		if (!(filled & CELL_BIT (n)))
+			set_user_guess (n, SHAPE_EMPTY, standard_solution[n / 6][n % 6].flags);
+		else
+			set_user_guess (n, (moons & CELL_BIT (n)) ? SHAPE_MOON : SHAPE_SUN,
+					standard_solution[n / 6][n % 6].flags);
+	}
+}
+
+/*
+ * Append the move that just happened on @ncell to the journal of the game,
+ * creating the journal on the first one, under the first name not taken
+ * yet. A journal that can't be written is not worth interrupting the game,
+ * so failures are silently ignored
+ */
+void Board::journal_move (journal_type_t type, int ncell)
+{
+	int n;
+	puzzle_rec_t rec;
+	std::string path;
+
+	if (this->testing)
+		return;
+
+	if (!journal) {
+		save_puzzle (&rec);
+		for (n = 0; n < JOURNAL_NAME_TRIES; n++) {
+			if ((path = journal_default_path (seed, n)).empty ())
+				return;
+			if ((journal = journal_writer_create (path.c_str (), &rec, JOURNAL_SNAPSHOT_INTERVAL)) || errno != EEXIST)
+				break;
+		}
+		if (!journal)
+			return;
+	}
+
+	journal_writer_append (journal, type, ncell, get_user_shape (ncell),
+			       g_get_monotonic_time () - journal_t0, filled_mask, get_moons ());
+}
+
+// Apply a single move from a journal, without validating anything yet
+bool Board::apply_journal_move (const journal_rec_t *rec)
+{
+	int n = rec->ncell;
+
+	if (rec->type > JOURNAL_END)
+		return false;
+
+	if (rec->type == JOURNAL_CLEAR) {
+		restore_guess (0, 0);
+		return true;
+	}
+
+	if (n >= 36 || is_immutable (n) || rec->shape > SHAPE_EMPTY)
+		return false;
+
+	set_user_guess (n, (shape_t) rec->shape, standard_solution[n / 6][n % 6].flags);
+	return true;
+}
+
+/*
+ * Bring the board to the state it had after the first @nmoves moves of @j:
+ * start from the latest snapshot, so that at most interval moves are
+ * applied one by one, and then validate every row and column as if the
+ * player had just clicked on them
+ */
+bool Board::replay_journal (const journal_t *j, uint32_t nmoves)
+{
+	uint32_t i = 0;
+	uint64_t filled, moons;
+	const journal_rec_t *rec;
+
+	if (nmoves > j->nmoves)
+		return false;
+
+	load_puzzle (&j->hdr->puzzle);
+	if ((rec = journal_get_snapshot (j, nmoves))) {
+		journal_unpack (imm_mask, rec->snapshot, &filled, &moons);
+		restore_guess (filled, moons);
+		i = rec->nmove;
+	}
+
+	for (; i < nmoves; i++)
+		if (!apply_journal_move (journal_get_move (j, i)))
+			return false;
+
+	for (i = 0; i < 6; i++) {
+		validate_row (i);
+		validate_col (i);
+	}
+
+	return true;
+}
+
+// Reset every cell to its initial state, but keep the standard solution
+void Board::clear_cells ()
+{
 	for (int i = 0; i < 6; i++) {
 		for (int j = 0; j < 6; j++) {
 			standard_solution[i][j].ncell = i * 6 + j;
@@ -199,8 +538,6 @@ void Board::new_game ()
 			standard_solution[i][j].flags.bottom_equal = 0;
 			standard_solution[i][j].flags.left = 0;
 			standard_solution[i][j].flags.left_equal = 0;
-			standard_solution[i][j].flags.claim_for_hor_hatching = 0;
-			standard_solution[i][j].flags.claim_for_ver_hatching = 0;
 
 			user_guess[i][j].ncell = i * 6 + j;
 			user_guess[i][j].shape = SHAPE_EMPTY;
@@ -213,11 +550,25 @@ void Board::new_game ()
 			user_guess[i][j].flags.bottom_equal = 0;
 			user_guess[i][j].flags.left = 0;
 			user_guess[i][j].flags.left_equal = 0;
-			user_guess[i][j].flags.claim_for_hor_hatching = 0;
-			user_guess[i][j].flags.claim_for_ver_hatching = 0;
 		}
 	}
-	this->configured = false;
+	hor_hatching = 0;
+	ver_hatching = 0;
+	imm_mask = 0;
+	filled_mask = 0;
+	user_hash = 0;
+	memset (conflicts, 0, sizeof (conflicts));
+	memset (&hint_lines, 0, sizeof (hint_lines));
+	hint_lines.dirty = (1 << HINT_NUM_LINES) - 1;
+	hint.rule = HINT_NONE;
+}
+
+void Board::restart ()
+{
+	journal_writer_close (journal);
+	journal = nullptr;
+	journal_t0 = g_get_monotonic_time ();
+	game_over = false;
 	cbdata.set_minutes (0);
 	cbdata.set_seconds (0);
 	cbdata.start_timer ();
@@ -231,6 +582,17 @@ void Board::set_seed (int seed)
 	this->seed = seed;
 }
 
+/*
+ * Number of immutable cells of the next boards (up to 6, one per row and
+ * column), and whether more of them should be added when needed to leave
+ * a single solution. Boards of the day always use the defaults
+ */
+void Board::set_givens (int count, bool unique)
+{
+	this->ngivens = count < 0 ? 0 : count > 6 ? 6 : count;
+	this->unique_givens = unique;
+}
+
 void Board::draw_shape (int nrow, int ncol, shape_t shape)
 {
 	struct _GdkRGBA color[2] = {	{ 0.7, 0.7, 0.2, 1.0, },
@@ -240,15 +602,15 @@ void Board::draw_shape (int nrow, int ncol, shape_t shape)
 	struct _GdkRGBA darkercolor = { 0.0, 0.1, 0.2, 1.0 };
 	struct _GdkRGBA gridcolor = normalcolor;
 
-	double x_scale = gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	cairo_save (cr);
 	if (shape == SHAPE_SUN) {		// Draw just a sun...
 		gdk_cairo_set_source_rgba (cr, &color[SHAPE_SUN]);
 		cairo_arc (cr, (ncol * 80 + 40) * x_scale, (nrow * 80 + 40) * y_scale, 30 * x_scale, 0 * y_scale, 2 * G_PI);
 		cairo_fill (cr);
 	} else if (shape == SHAPE_MOON) {	// ...and a moon
-		if (standard_solution[nrow][ncol].flags.imm)
+		if (imm_mask & CELL_BIT (nrow * 6 + ncol))
 			gridcolor = darkercolor;
 		gdk_cairo_set_source_rgba (cr, &gridcolor);
 		cairo_rectangle (cr, (ncol * 80 + 2) * x_scale, (nrow * 80 + 2) * y_scale, 76 * x_scale, 76 * y_scale);
@@ -277,8 +639,8 @@ void Board::draw_cells (cairo_t *cr)
 	gdk_cairo_set_source_rgba (cr, &gridcolor);
 
 	// The original size of the window is 480x480 px
-	double x_scale = gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	for (i = 0; i < 6; i++)
 		for (j = 0; j < 6; j++)
 			cairo_rectangle (cr, (i * 80 + 2) * x_scale, (j * 80 + 2) * y_scale, 76 * x_scale, 76 * y_scale);
@@ -292,6 +654,8 @@ void Board::draw_cells (cairo_t *cr)
 		} else {
 			set_immutable_cells ();
 			set_constraints ();
+			if (unique_givens)
+				make_unique ();
 		}
 		this->configured = true;
 	}
@@ -299,36 +663,49 @@ void Board::draw_cells (cairo_t *cr)
 	draw_constraints ();
 }
 
-bool Board::can_draw_hatching (int ncell)
+bool Board::can_draw_hatching (int ncell) const
 {
-	if (user_guess[ncell / 6][ncell % 6].flags.claim_for_hor_hatching ||
-	    user_guess[ncell / 6][ncell % 6].flags.claim_for_ver_hatching)
-		return true;
-	return false;
+	return ((hor_hatching | ver_hatching) & CELL_BIT (ncell)) != 0;
 }
 
 void Board::set_hatching (int ncell, bool hor)
+{
+	set_hatching_mask (CELL_BIT (ncell), hor);
+}
+
+void Board::clear_hatching (int ncell, bool hor)
+{
+	clear_hatching_mask (CELL_BIT (ncell), hor);
+}
+
+// Hatch every cell in @mask at once, e.g. ROW_MASK (n) for the whole row n
+void Board::set_hatching_mask (uint64_t mask, bool hor)
 {
 	if (hor)
-		user_guess[ncell / 6][ncell % 6].flags.claim_for_hor_hatching = 1;
+		hor_hatching |= mask;
 	else
-		user_guess[ncell / 6][ncell % 6].flags.claim_for_ver_hatching = 1;
+		ver_hatching |= mask;
 }
 
-void Board::clear_hatching (int ncell, bool hor)
+void Board::clear_hatching_mask (uint64_t mask, bool hor)
 {
 	if (hor)
-		user_guess[ncell / 6][ncell % 6].flags.claim_for_hor_hatching = 0;
+		hor_hatching &= ~mask;
 	else
-		user_guess[ncell / 6][ncell % 6].flags.claim_for_ver_hatching = 0;
+		ver_hatching &= ~mask;
+}
+
+uint64_t Board::get_hatching () const
+{
+	return hor_hatching | ver_hatching;
 }
 
 void Board::draw_hatching (int ncell)
 {
 	struct _GdkRGBA hatching_color = { 0.6, 0.0, 0.0, 1.0 };
 
-	double x_scale = gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	cairo_save (cr);
 	gdk_cairo_set_source_rgba (cr, &hatching_color);
 	for (int i = 0; i < 4; i++) {
@@ -346,27 +723,12 @@ void Board::draw_hatching (int ncell)
 
 void Board::draw_hatching_on_immutable ()
 {
-	int i, j;
-
-	for (i = 0; i < 6; i++) {
-		for (j = 0; j < 6; j++) {
-			if (user_guess[i][j].flags.imm) {
-				if (user_guess[i][j].flags.claim_for_hor_hatching) {
-					set_hatching (i * 6 + j, true);
-					draw_hatching (i * 6 + j);
-				} else {
-					clear_hatching (i * 6 + j, true);
-				}
+	uint64_t m;
 
-				if (user_guess[i][j].flags.claim_for_ver_hatching) {
-					set_hatching (i * 6 + j, false);
-					draw_hatching (i * 6 + j);
-				} else {
-					clear_hatching (i * 6 + j, false);
-				}
-			}
-		}
-	}
+	for (m = imm_mask & hor_hatching; m; )
+		draw_hatching (pop_cell (&m));
+	for (m = imm_mask & ver_hatching; m; )
+		draw_hatching (pop_cell (&m));
 }
 
 bool Board::get_game_over ()
@@ -375,24 +737,22 @@ bool Board::get_game_over ()
 }
 
 /*
- * The game is over iff the location of the shapes on the board are valid and
- * there's no additional hatchings on any cell (this is a workaround for a
- * bug which let you end the game successfully even when there was at least
- * one cell marked as wrong)
+ * The game is over iff the board is full, the location of the shapes on the
+ * board are valid and there's no additional hatchings on any cell (this is a
+ * workaround for a bug which let you end the game successfully even when
+ * there was at least one cell marked as wrong). is_valid () alone says
+ * nothing about empty cells, hence the check on the filled mask
  */
 void Board::set_game_over (bool game_over)
 {
-	int i, j, row = -1, col = -1, nsuns = -1, nmoons = -1;
-	int err_invalid = 0, hatchings_to_change = 0;
+	int row = -1, col = -1, nsuns = -1, nmoons = -1;
+	int err_invalid = 0;
+
+	if (filled_mask != ((uint64_t) 1 << 36) - 1)
+		return;
 
 	err_invalid = is_valid (&row, &col, &nsuns, &nmoons, false);
-	for (i = 0; i < 6; i++)
-		for (j = 0; j < 6; j++)
-			if (user_guess[i][j].flags.claim_for_hor_hatching ||
-			    user_guess[i][j].flags.claim_for_ver_hatching)
-				hatchings_to_change++;
-				
-	if (!err_invalid && !hatchings_to_change)
+	if (!err_invalid && !get_hatching ())
 		this->game_over = game_over;
 }
 
@@ -401,8 +761,8 @@ void Board::show_congrats ()
 	struct _GdkRGBA bgcolor = { 0.3, 0.6, 0.3, 0.8 };
 	struct _GdkRGBA fgcolor = { 1.0, 1.0, 1.0, 1.0 };
 
-	double x_scale = gtk_widget_get_allocated_width (da) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (da) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	cairo_save (cr);
 	gdk_cairo_set_source_rgba (cr, &bgcolor);
 	cairo_rectangle (cr, 120 * x_scale, 180 * y_scale, 240 * x_scale, 120 * y_scale);
@@ -421,23 +781,23 @@ void Board::show_congrats ()
 void Board::change_shape (int nrow, int ncol)
 {
 	if (standard_solution[nrow][ncol].shape == SHAPE_SUN)
-		standard_solution[nrow][ncol].shape = SHAPE_MOON;
+		set_shape_status (nrow * 6 + ncol, SHAPE_MOON);
 	else
-		standard_solution[nrow][ncol].shape = SHAPE_SUN;
+		set_shape_status (nrow * 6 + ncol, SHAPE_SUN);
 }
 
 void Board::change_row (int nrow, shape_t shape)
 {
 	for (int j = 0; j < 4; j++)
 		if (standard_solution[nrow][j].shape == shape && standard_solution[nrow][j + 1].shape == shape)
-			standard_solution[nrow][j + 2].shape = (shape == SHAPE_SUN) ? SHAPE_MOON : SHAPE_SUN;
+			set_shape_status (nrow * 6 + j + 2, (shape == SHAPE_SUN) ? SHAPE_MOON : SHAPE_SUN);
 }
 
 void Board::change_col (int ncol, shape_t shape)
 {
 	for (int i = 0; i < 4; i++)
 		if (standard_solution[i][ncol].shape == shape && standard_solution[i + 1][ncol].shape == shape)
-			standard_solution[i + 2][ncol].shape = (shape == SHAPE_SUN) ? SHAPE_MOON : SHAPE_SUN;
+			set_shape_status ((i + 2) * 6 + ncol, (shape == SHAPE_SUN) ? SHAPE_MOON : SHAPE_SUN);
 }
 
 shape_info_t Board::get_shape_status (int ncell) const
@@ -455,15 +815,80 @@ shape_info_t Board::get_standard_solution (int ncell) const
 	return standard_solution[ncell / 6][ncell % 6];
 }
 
+/*
+ * The getters above return whole copies of the cells, which is wasteful
+ * when all we want is the shape, or when walking a whole line. These ones
+ * hand out references into the board instead, so they are only valid as
+ * long as the board is not modified
+ */
+shape_t Board::get_user_shape (int ncell) const
+{
+	return user_guess[ncell / 6][ncell % 6].shape;
+}
+
+shape_t Board::get_solution_shape (int ncell) const
+{
+	return standard_solution[ncell / 6][ncell % 6].shape;
+}
+
+const shape_info_t& Board::view_user_guess (int ncell) const
+{
+	return user_guess[ncell / 6][ncell % 6];
+}
+
+const shape_info_t& Board::view_standard_solution (int ncell) const
+{
+	return standard_solution[ncell / 6][ncell % 6];
+}
+
+cell_view_t Board::view_row (int nrow, bool std) const
+{
+	cell_view_t v = { std ? &standard_solution[nrow][0] : &user_guess[nrow][0], 1, 6 };
+
+	return v;
+}
+
+cell_view_t Board::view_col (int ncol, bool std) const
+{
+	cell_view_t v = { std ? &standard_solution[0][ncol] : &user_guess[0][ncol], 6, 6 };
+
+	return v;
+}
+
+cell_view_t Board::view_board (bool std) const
+{
+	cell_view_t v = { std ? &standard_solution[0][0] : &user_guess[0][0], 1, 36 };
+
+	return v;
+}
+
+/*
+ * Both setters keep the Zobrist hashes up to date, by XORing the key of the
+ * shape being replaced out and the key of the new one in
+ */
 void Board::set_shape_status (int ncell, shape_t sh)
 {
+	solution_hash ^= zobrist_key (ncell, standard_solution[ncell / 6][ncell % 6].shape) ^ zobrist_key (ncell, sh);
 	standard_solution[ncell / 6][ncell % 6].shape = sh;
 }
 
 void Board::set_user_guess (int ncell, shape_t sh, bm_flags_t flags)
 {
+	user_hash ^= zobrist_key (ncell, user_guess[ncell / 6][ncell % 6].shape) ^ zobrist_key (ncell, sh);
 	user_guess[ncell / 6][ncell % 6].shape = sh;
 	user_guess[ncell / 6][ncell % 6].flags = flags;
+	if (sh == SHAPE_EMPTY)
+		filled_mask &= ~CELL_BIT (ncell);
+	else
+		filled_mask |= CELL_BIT (ncell);
+	hor_hatching &= ~CELL_BIT (ncell);
+	ver_hatching &= ~CELL_BIT (ncell);
+	for (int r = 0; r < VALIDATE_NUM_RULES; r++) {
+		conflicts[r][ncell / 6] &= ~(1 << (ncell % 6));
+		conflicts[r][6 + ncell % 6] &= ~(1 << (ncell / 6));
+	}
+	hint_lines.dirty |= (1 << (ncell / 6)) | (1 << (6 + ncell % 6));
+	hint.rule = HINT_NONE;
 }
 
 int Board::get_num_hsuns (int row, bool std)
@@ -599,685 +1024,510 @@ int Board::get_third_adjacent (int row, int col, line_type_check check, bool std
 	return -1;
 }
 
+/*
+ * Check the whole board with validate_board (), so that rows and columns
+ * are all done at once. Bit 0 is set for three adjacent shapes on a column
+ * and bit 2 on a row (@col and @row get the last of them), bit 1 for a row
+ * holding more than three suns or moons and bit 3 for a column (@nsuns and
+ * @nmoons get the shapes of the last of them, columns first).
+ *
+ * Empty cells break no rule, so 0 only means that no rule is broken so far,
+ * not that the board is solved: a partial line is no longer flagged as
+ * unbalanced, as the per-line checks used to do. Callers deciding that the
+ * game is over must check that the board is full as well
+ */
 int Board::is_valid (int *row, int *col, int *nsuns, int *nmoons, bool std)
 {
-	int i, j, ret = 0;
+	TRACE_SCOPE (TRACE_IS_VALID);
+	int i, ret = 0, adjs, balance;
+	uint64_t filled = filled_mask, moons, line;
+
+	if (std) {
+		filled = ((uint64_t) 1 << 36) - 1;
+		for (i = 0, moons = 0; i < 36; i++)
+			if (standard_solution[i / 6][i % 6].shape == SHAPE_MOON)
+				moons |= CELL_BIT (i);
+	} else {
+		moons = get_moons ();
+	}
 
-	for (i = 0; i < 6; i++) {
-		j = get_third_adjacent (-1, i, COL, std);
-		if (j != -1) {
-			*col = i;
-			ret |= 1;
-		}
-		if (get_num_hsuns (i, std) != get_num_hmoons (i, std)) {
-			*nsuns = get_num_hsuns (i, std);
-			*nmoons = get_num_hmoons (i, std);
-			ret |= 2;
-		}
+	line = validate_board (filled, moons, nullptr);
+	adjs = VALIDATE_LINES (line, VALIDATE_THREE_ADJS);
+	balance = VALIDATE_LINES (line, VALIDATE_BALANCE);
+
+	if (adjs >> 6) {
+		*col = 31 - __builtin_clz (adjs >> 6);
+		ret |= 1;
+	}
+	if (adjs & 0x3f) {
+		*row = 31 - __builtin_clz (adjs & 0x3f);
+		ret |= 4;
 	}
 
-	for (i = 0; i < 6; i++) {
-		j = get_third_adjacent (i, -1, ROW, std);
-		if (j != -1) {
-			*row = i;
-			ret |= 4;
-		}
-		if (get_num_vsuns (i, std) != get_num_vmoons (i, std)) {
-			*nsuns = get_num_vsuns (i, std);
-			*nmoons = get_num_vmoons (i, std);
-			ret |= 8;
-		}
+	if (balance & 0x3f)
+		ret |= 2;
+	if (balance >> 6)
+		ret |= 8;
+	if (balance) {
+		i = 31 - __builtin_clz (balance);
+		line = i < 6 ? ROW_MASK (i) : COL_MASK (i - 6);
+		*nmoons = __builtin_popcountll (moons & line);
+		*nsuns = __builtin_popcountll (filled & ~moons & line);
 	}
 
 	return ret;
 }
 
-void Board::validate_row_diff_num_of_shapes (int nrow)
+/*
+ * Hatch the cells of a line that break some rule, and only those: runs of
+ * three equal shapes, the shape in excess, and both sides of a constraint
+ * not honored. The whole line is worked out in a single pass, so the
+ * hatching of rows and columns always matches the board as it is now
+ */
+void Board::check_line (int line)
 {
-	int i, suns = 0, moons = 0;
-
-	for (i = 0; i < 6; i++) {
-		shape_info_t& r = user_guess[nrow][i];
-		if (r.shape == SHAPE_EMPTY)
-			clear_hatching (nrow * 6 + i, true);
-		if (r.shape == SHAPE_SUN)
-			suns++;
-		else if (r.shape == SHAPE_MOON)
-			moons++;
-	}
-
-	if (suns + moons == 6) {
-		if (suns < 3 || moons < 3) {
-			// If suns == (0, 1, 2) && moons == (6, 5, 4)
-			for (i = 0; i < 6; i++)
-				set_hatching (nrow * 6 + i, true);
+	int c, r;
+	uint8_t filled = 0, moons = 0, equal = 0, diff = 0, all = 0;
+	uint8_t line_conflicts[VALIDATE_NUM_RULES];
+	uint64_t mask = 0;
+
+	for (c = 0; c < 6; c++) {
+		const shape_info_t& ref = (line < 6) ? user_guess[line][c] : user_guess[c][line - 6];
+
+		if (ref.shape != SHAPE_EMPTY)
+			filled |= 1 << c;
+		if (ref.shape == SHAPE_MOON)
+			moons |= 1 << c;
+
+		// Constraints may be attached to either cell of the edge
+		if (line < 6) {
+			if (c < 5 && ref.flags.right)
+				*(ref.flags.right_equal ? &equal : &diff) |= 1 << c;
+			if (c > 0 && ref.flags.left)
+				*(ref.flags.left_equal ? &equal : &diff) |= 1 << (c - 1);
 		} else {
-			for (i = 0; i < 6; i++)
-				clear_hatching (nrow * 6 + i, true);
+			if (c < 5 && ref.flags.bottom)
+				*(ref.flags.bottom_equal ? &equal : &diff) |= 1 << c;
+			if (c > 0 && ref.flags.top)
+				*(ref.flags.top_equal ? &equal : &diff) |= 1 << (c - 1);
 		}
-	} else {
-		for (i = 0; i < 6; i++)
-			clear_hatching (nrow * 6 + i, true);
 	}
+
+	validate_line (filled, moons, equal, diff, line_conflicts);
+	for (r = 0; r < VALIDATE_NUM_RULES; r++) {
+		conflicts[r][line] = line_conflicts[r];
+		all |= line_conflicts[r];
+	}
+
+	for (c = 0; c < 6; c++)
+		if ((all >> c) & 1)
+			mask |= CELL_BIT ((line < 6) ? line * 6 + c : c * 6 + line - 6);
+	if (line < 6)
+		hor_hatching = (hor_hatching & ~ROW_MASK (line)) | mask;
+	else
+		ver_hatching = (ver_hatching & ~COL_MASK (line - 6)) | mask;
 }
 
-void Board::validate_row_three_adjs (int nrow)
+void Board::validate_row (int nrow)
 {
-	int i;
-
-	for (i = 0; i < 4; i++) {
-		shape_info_t& r0 = user_guess[nrow][i + 0];
-		shape_info_t& r1 = user_guess[nrow][i + 1];
-		shape_info_t& r2 = user_guess[nrow][i + 2];
-		if (r0.shape == SHAPE_EMPTY || r1.shape == SHAPE_EMPTY || r2.shape == SHAPE_EMPTY) {
-			clear_hatching (nrow * 6 + i + 0, true);
-			clear_hatching (nrow * 6 + i + 1, true);
-			clear_hatching (nrow * 6 + i + 2, true);
-		}
+	TRACE_SCOPE (TRACE_VALIDATE_ROW);
+	check_line (nrow);
+}
 
-		if (r0.shape != SHAPE_EMPTY && r0.shape == r1.shape && r1.shape == r2.shape) {
-			set_hatching (nrow * 6 + i + 0, true);
-			set_hatching (nrow * 6 + i + 1, true);
-			set_hatching (nrow * 6 + i + 2, true);
-			i += 2;
-		} else {
-			if (get_num_hsuns (nrow, true) + get_num_hmoons (nrow, true) == 6 &&
-			    get_num_hsuns (nrow, true) != get_num_hmoons (nrow, true)) {
-				clear_hatching (nrow * 6 + i + 0, true);
-				clear_hatching (nrow * 6 + i + 1, true);
-				clear_hatching (nrow * 6 + i + 2, true);
-			}
-		}
-	}
+void Board::validate_col (int ncol)
+{
+	TRACE_SCOPE (TRACE_VALIDATE_COL);
+	check_line (6 + ncol);
 }
 
-void Board::validate_row_constraints (int nrow)
+// Cells breaking @rule (VALIDATE_THREE_ADJS, ...) on their row or column
+uint64_t Board::get_conflicts (int rule) const
 {
-	int i;
+	int line, c;
+	uint64_t mask = 0;
 
-	for (i = 0; i < 5; i++) {
-		shape_info_t& r = user_guess[nrow][i];
-		if (r.flags.right) {
-			shape_info_t& next = user_guess[nrow][i + 1];
-			if (r.flags.right_equal) {
-				// We need to check for the value of "next.shape"
-				// to be not equal to SHAPE_EMPTY alongside the
-				// r.shape as well. If we wouldn't do, it would
-				// lead to a buggy behavior by hatching the first
-				// or the second cell even when they should not
-				// do it. Same fix for right_diff and corresponding
-				// validate_col_constraints ()
-				if (r.shape != next.shape && r.shape != SHAPE_EMPTY && next.shape != SHAPE_EMPTY) {
-					set_hatching (nrow * 6 + i + 0, true);
-					set_hatching (nrow * 6 + i + 1, true);
-				} else {
-					if (get_num_hsuns (nrow, true) + get_num_hmoons (nrow, true) == 6 &&
-					    get_num_hsuns (nrow, true) != get_num_hmoons (nrow, true)) {
-						clear_hatching (nrow * 6 + i + 0, true);
-						clear_hatching (nrow * 6 + i + 1, true);
-					}
-				}
-			} else {
-				if (r.shape == next.shape && r.shape != SHAPE_EMPTY && next.shape != SHAPE_EMPTY) {
-					set_hatching (nrow * 6 + i + 0, true);
-					set_hatching (nrow * 6 + i + 1, true);
-				} else {
-					if (get_num_hsuns (nrow, true) + get_num_hmoons (nrow, true) == 6 &&
-					    get_num_hsuns (nrow, true) != get_num_hmoons (nrow, true)) {
-						clear_hatching (nrow * 6 + i + 0, true);
-						clear_hatching (nrow * 6 + i + 1, true);
-					}
-				}
-			}
-		}
-	}
+	for (line = 0; line < 12; line++)
+		for (c = 0; c < 6; c++)
+			if ((conflicts[VALIDATE_RULE (rule)][line] >> c) & 1)
+				mask |= CELL_BIT ((line < 6) ? line * 6 + c : c * 6 + line - 6);
 
-	for (i = 1; i < 6; i++) {
-		shape_info_t& r = user_guess[nrow][i];
-		if (r.flags.left) {
-			shape_info_t& prev = user_guess[nrow][i - 1];
-			if (r.flags.left_equal) {
-				if (r.shape != prev.shape && r.shape != SHAPE_EMPTY && prev.shape != SHAPE_EMPTY) {
-					set_hatching (nrow * 6 + i - 0, true);
-					set_hatching (nrow * 6 + i - 1, true);
-				} else {
-					if (get_num_hsuns (nrow, true) + get_num_hmoons (nrow, true) == 6 &&
-					    get_num_hsuns (nrow, true) != get_num_hmoons (nrow, true)) {
-						clear_hatching (nrow * 6 + i - 0, true);
-						clear_hatching (nrow * 6 + i - 1, true);
-					}
-				}
-			} else {
-				if (r.shape == prev.shape && r.shape != SHAPE_EMPTY && prev.shape != SHAPE_EMPTY) {
-					set_hatching (nrow * 6 + i - 0, true);
-					set_hatching (nrow * 6 + i - 1, true);
-				} else {
-					if (get_num_hsuns (nrow, true) + get_num_hmoons (nrow, true) == 6 &&
-					    get_num_hsuns (nrow, true) != get_num_hmoons (nrow, true)) {
-						clear_hatching (nrow * 6 + i - 0, true);
-						clear_hatching (nrow * 6 + i - 1, true);
-					}
-				}
-			}
-		}
-	}
+	return mask;
 }
 
-void Board::validate_row (int nrow)
+/*
+ * Before the game starts, we need to prepare all the cells for the standard
+ * solution. Every valid grid is known in advance (see solver_get_grids ()),
+ * so we only have to pick one of them at random
+ */
+void Board::prepare ()
 {
-	validate_row_diff_num_of_shapes (nrow);
-	validate_row_three_adjs (nrow);
-	validate_row_constraints (nrow);
+	TRACE_SCOPE (TRACE_PREPARE);
+	int i;
+	const uint64_t *grids;
+	size_t count = solver_get_grids (&grids);
+	uint64_t solution = grids[rand () % count];
+
+	for (i = 0; i < 36; i++)
+		standard_solution[i / 6][i % 6].shape = ((solution >> i) & 1) ? SHAPE_MOON : SHAPE_SUN;
+	rehash ();
+	LOG_PRINTF (LOG_LEVEL_INFO, "%s(): solution = 0x%09llx", __FUNCTION__, (unsigned long long) solution);
 }
 
-void Board::validate_col_diff_num_of_shapes (int ncol)
+/*
+ * Render the user's guess with ANSI colors for the unit tests. The rendered
+ * board is kept by the step trace, which is only compiled in test builds
+ */
+void Board::print (bool is_testing, bool display_values, int n_step)
 {
-	int i, suns = 0, moons = 0;
+#ifdef TANGORINEBA_STEP_TRACE
+	int i, j;
+	std::string text;
+	typedef enum { COLOR_RED = 0, COLOR_YELLOW, COLOR_WHITE,
+			COLOR_BLACK_FG_YELLOW_BG, COLOR_WHITE_FG_BLUE_BG,
+			COLOR_RED_FG_WHITE_BG, COLOR_NORMAL } color_t;
+	static const char *esc_seq[7] = {
+				"\033[01;40;31m",
+				"\033[01;40;33m",
+				"\033[01;40;37m",
+				"\033[00;43;30m",
+				"\033[01;44;37m",
+				"\033[01;47;31m",
+				"\033[00m",
+	};
+
+	if (!is_testing)
+		return;
 
 	for (i = 0; i < 6; i++) {
-		shape_info_t& r = user_guess[i][ncol];
-		if (r.shape == SHAPE_EMPTY)
-			clear_hatching (i * 6 + ncol, false);
-		if (r.shape == SHAPE_SUN)
-			suns++;
-		else if (r.shape == SHAPE_MOON)
-			moons++;
-	}
+		for (j = 0; j < 6; j++) {
+			const shape_info_t& ref = user_guess[i][j];
+			bool hatched = can_draw_hatching (i * 6 + j);
 
-	if (suns + moons == 6) {
-		if (suns < 3 || moons < 3) {
-			for (i = 0; i < 6; i++)
-				set_hatching (i * 6 + ncol, false);
-		} else {
-			for (i = 0; i < 6; i++)
-				clear_hatching (i * 6 + ncol, false);
+			if (ref.shape == SHAPE_SUN) {
+				if (hatched)
+					text += esc_seq[ref.flags.imm ? COLOR_RED_FG_WHITE_BG : COLOR_RED];
+				else
+					text += esc_seq[ref.flags.imm ? COLOR_BLACK_FG_YELLOW_BG : COLOR_YELLOW];
+				text += "*";
+			} else if (ref.shape == SHAPE_MOON) {
+				if (hatched)
+					text += esc_seq[ref.flags.imm ? COLOR_RED_FG_WHITE_BG : COLOR_RED];
+				else
+					text += esc_seq[ref.flags.imm ? COLOR_WHITE_FG_BLUE_BG : COLOR_WHITE];
+				text += "D";
+			} else {
+				text += "_";
+			}
+			text += esc_seq[COLOR_NORMAL];
+			text += " ";
 		}
-	} else {
-		for (i = 0; i < 6; i++)
-			clear_hatching (i * 6 + ncol, false);
+		text += "\n";
 	}
+	step_trace.record (n_step, text);
+
+	if (display_values)
+		LOG_LINES (LOG_LEVEL_INFO, ("step n = " + std::to_string (n_step) + "\n" + text).c_str ());
+#endif
 }
 
-void Board::validate_col_three_adjs (int ncol)
+bool Board::is_immutable (int n) const
 {
-	int i;
+	return (imm_mask & CELL_BIT (n)) != 0;
+}
 
-	for (i = 0; i < 4; i++) {
-		shape_info_t& r0 = user_guess[i + 0][ncol];
-		shape_info_t& r1 = user_guess[i + 1][ncol];
-		shape_info_t& r2 = user_guess[i + 2][ncol];
-		if (r0.shape == SHAPE_EMPTY || r1.shape == SHAPE_EMPTY || r2.shape == SHAPE_EMPTY) {
-			clear_hatching ((i + 0) * 6 + ncol, false);
-			clear_hatching ((i + 1) * 6 + ncol, false);
-			clear_hatching ((i + 2) * 6 + ncol, false);
-		}
+uint64_t Board::get_immutable () const
+{
+	return imm_mask;
+}
 
-		if (r0.shape != SHAPE_EMPTY && r0.shape == r1.shape && r1.shape == r2.shape) {
-			set_hatching ((i + 0) * 6 + ncol, false);
-			set_hatching ((i + 1) * 6 + ncol, false);
-			set_hatching ((i + 2) * 6 + ncol, false);
-			i += 2;
-		} else {
-			if (get_num_vsuns (ncol, true) + get_num_vmoons (ncol, true) == 6 &&
-			    get_num_vsuns (ncol, true) != get_num_vmoons (ncol, true)) {
-				clear_hatching ((i + 0) * 6 + ncol, false);
-				clear_hatching ((i + 1) * 6 + ncol, false);
-				clear_hatching ((i + 2) * 6 + ncol, false);
-			}
-		}
-	}
+uint64_t Board::get_filled () const
+{
+	return filled_mask;
 }
 
-void Board::validate_col_constraints (int ncol)
+int Board::get_num_filled () const
 {
-	int i;
+	return __builtin_popcountll (filled_mask);
+}
 
-	for (i = 1; i < 6; i++) {
-		shape_info_t& r = user_guess[i][ncol];
-		if (r.flags.top) {
-			shape_info_t& prev = user_guess[i - 1][ncol];
-			if (r.flags.top_equal) {
-				if (r.shape != prev.shape && r.shape != SHAPE_EMPTY && prev.shape != SHAPE_EMPTY) {
-					set_hatching ((i - 0) * 6 + ncol, false);
-					set_hatching ((i - 1) * 6 + ncol, false);
-				} else {
-					if (get_num_vsuns (ncol, true) + get_num_vmoons (ncol, true) == 6 &&
-					    get_num_vsuns (ncol, true) != get_num_vmoons (ncol, true)) {
-						clear_hatching ((i - 0) * 6 + ncol, false);
-						clear_hatching ((i - 1) * 6 + ncol, false);
-					}
-				}
-			} else {
-				if (r.shape == prev.shape && r.shape != SHAPE_EMPTY && prev.shape != SHAPE_EMPTY) {
-					set_hatching ((i - 0) * 6 + ncol, false);
-					set_hatching ((i - 1) * 6 + ncol, false);
-				} else {
-					if (get_num_vsuns (ncol, true) + get_num_vmoons (ncol, true) == 6 &&
-					    get_num_vsuns (ncol, true) != get_num_vmoons (ncol, true)) {
-						clear_hatching ((i - 0) * 6 + ncol, false);
-						clear_hatching ((i - 1) * 6 + ncol, false);
-					}
-				}
-			}
-		}
-	}
+uint64_t Board::get_moons () const
+{
+	int n;
+	uint64_t m, moons = 0;
 
-	for (i = 0; i < 5; i++) {
-		shape_info_t& r = user_guess[i][ncol];
-		if (r.flags.bottom) {
-			shape_info_t& next = user_guess[i + 1][ncol];
-			if (r.flags.bottom_equal) {
-				if (r.shape != next.shape && r.shape != SHAPE_EMPTY && next.shape != SHAPE_EMPTY) {
-					set_hatching ((i + 0) * 6 + ncol, false);
-					set_hatching ((i + 1) * 6 + ncol, false);
-				} else {
-					if (get_num_vsuns (ncol, true) + get_num_vmoons (ncol, true) == 6 &&
-					    get_num_vsuns (ncol, true) != get_num_vmoons (ncol, true)) {
-						clear_hatching ((i + 0) * 6 + ncol, false);
-						clear_hatching ((i + 1) * 6 + ncol, false);
-					}
-				}
-			} else {
-				if (r.shape == next.shape && r.shape != SHAPE_EMPTY && next.shape != SHAPE_EMPTY) {
-					set_hatching ((i + 0) * 6 + ncol, false);
-					set_hatching ((i + 1) * 6 + ncol, false);
-				} else {
-					if (get_num_vsuns (ncol, true) + get_num_vmoons (ncol, true) == 6 &&
-					    get_num_vsuns (ncol, true) != get_num_vmoons (ncol, true)) {
-						clear_hatching ((i + 0) * 6 + ncol, false);
-						clear_hatching ((i + 1) * 6 + ncol, false);
-					}
-				}
-			}
-		}
+	for (m = filled_mask; m; ) {
+		n = pop_cell (&m);
+		if (user_guess[n / 6][n % 6].shape == SHAPE_MOON)
+			moons |= CELL_BIT (n);
 	}
+
+	return moons;
 }
 
-void Board::validate_col (int ncol)
+uint64_t Board::get_user_hash () const
 {
-	validate_col_diff_num_of_shapes (ncol);
-	validate_col_three_adjs (ncol);
-	validate_col_constraints (ncol);
+	return user_hash;
 }
 
-std::list<std::vector<int>>::iterator get_nth_iter (std::list<std::vector<int>>& l, int nth)
+uint64_t Board::get_solution_hash () const
 {
-	int i;
-	std::list<std::vector<int>>::iterator iter;
-
-	for (i = 0, iter = l.begin (); iter != l.end (); iter++, i++)
-		if (i == nth)
-			return iter;
-
-	return l.end ();
+	return solution_hash;
 }
 
 /*
- * Before the game starts, we need to prepare all the cells for the standard
- * solution. We know that's a little bit tricky to explain what we did for it
- * to work fine, but our approach is as follows:
- *
- * 1. Create a B-Tree and populate it with 128 branches
- * 2. Select only 6-step paths starting from 64 and ending at 128
- * 3. Generate the two first rows as random but distinct from each other
- * 4. Prepare a 1's complemented boolean identity matrix of 4 possible values
- * 5. Get the paths from the digraph and map each one to numbers 0 =< x =< 3
- * 6. Complete the last 4 rows with the mappings gotten in the previous step
- *
+ * Compute both hashes from scratch, for the places that fill many cells at
+ * once without going through set_user_guess () or set_shape_status (). The
+ * hints of every line have to be worked out again as well
  */
-void Board::prepare ()
+void Board::rehash ()
 {
-	int i, j, t, level, *path, err;
-	int nsuns = 0, nmoons = 0, row, col;
-	int **mtx = nullptr;
-	bool has_three_adjs = false;
-	BTree<int> bt (1);
-	std::vector<int> hvect (6);
-	std::list<digraph_t> *l;
-	std::list<std::vector<int>> hlst;
-	std::list<std::vector<int>>::iterator iter;
-	std::list<digraph_t>::iterator vec_iter;
-
-	for (i = 2; i < 0x80; i++) {
-		if (!(i & 1))
-			bt.add_branch (i, (int) SHAPE_MOON);
-		else
-			bt.add_branch (i, (int) SHAPE_SUN);
-	}
-
-	for (i = 0x40; i < 0x80; i++) {
-		has_three_adjs = false;
-		path = bt.get_path (i, &level);
-		for (j = level - 1; j > -1; j--) {
-			if (path[j])
-				nsuns++;
-			else
-				nmoons++;
-		}
-
-		if (nsuns == nmoons) {
-			for (j = 0; j < 4; j++) {
-				if (path[j] == path[j + 1] && path[j + 1] == path[j + 2]) {
-					has_three_adjs = true;
-					nsuns = 0;
-					nmoons = 0;
-					break;
-				}
-			}
+	int n;
+	uint64_t moons = 0;
+
+	for (n = 0; n < 36; n++)
+		if (standard_solution[n / 6][n % 6].shape == SHAPE_MOON)
+			moons |= CELL_BIT (n);
+	solution_hash = zobrist_hash (((uint64_t) 1 << 36) - 1, moons);
+	user_hash = zobrist_hash (filled_mask, get_moons ());
+	hint_lines.dirty = (1 << HINT_NUM_LINES) - 1;
+}
 
-			if (!has_three_adjs) {
-				for (j = level - 1; j > -1; j--)
-					hvect[j] = path[j];
-				hlst.push_back (hvect);
-				has_three_adjs = false;
-				nsuns = 0;
-				nmoons = 0;
-			}
-		} else {
-			nsuns = 0;
-			nmoons = 0;
-		}
-	}
+// Whether some valid board, constraints included, agrees with the user's guess
+bool Board::can_be_completed () const
+{
+	puzzle_rec_t rec;
+	validate_cons_t cons;
 
-	int rnd0 = rand () % hlst.size ();
+	save_puzzle (&rec);
+	validate_get_cons (&rec, &cons);
 
-another_rand:
-	int rnd1 = rand () % hlst.size ();
-	if (rnd1 == rnd0)
-		goto another_rand;
-	int rnd = rnd0;
-	for (i = 0, t = 0, iter = hlst.begin (); iter != hlst.end (); iter++, i++) {
-		if (i < rnd)
-			continue;
-		for (j = 0; j < 6; j++)
-			standard_solution[t][j].shape = (shape_t) (*iter)[j];
+	return solver_can_complete (filled_mask, get_moons (), &cons);
+}
 
-		if (rnd == rnd0) {
-			rnd = rnd1;
-			i = 0;
-			t++;
-			iter = hlst.begin ();
-		} else {
-			break;
+/*
+ * Next cell that can be worked out from the user's guess, and the rule that
+ * tells its shape. This is called from the main loop, so it only looks at
+ * the lines changed since the last call; when no single line is enough, the
+ * grids are searched on a worker thread and HINT_PENDING is returned until
+ * hint_ready_cb () runs. The hint is drawn by draw_hint () until next move
+ */
+hint_t Board::next_hint ()
+{
+	uint64_t moons = get_moons (), key;
+	puzzle_rec_t rec;
+	validate_cons_t cons;
+	hint_t h = { -1, SHAPE_EMPTY, HINT_NONE };
+
+	save_puzzle (&rec);
+	validate_get_cons (&rec, &cons);
+	if (filled_mask == ((uint64_t) 1 << 36) - 1 || validate_board (filled_mask, moons, &cons))
+		return hint = h;
+
+	hint_update_lines (&hint_lines, filled_mask, moons, &cons);
+	if (!hint_pick (&hint_lines, &h)) {
+		key = search_key (&rec);
+		if (!hint_search_result (key, &h)) {
+			hint_search_start (key, filled_mask, moons, &cons, hint_ready_cb);
+			h.rule = HINT_PENDING;
 		}
 	}
 
-	mtx = new int* [4];
-	for (i = 0; i < 4; i++)
-		mtx[i] = new int [4];
-	for (iter = hlst.begin (), i = 0; i < 4; i++, iter++) {
-		for (j = 0; j < 4; j++) {
-			if (i != j)
-				mtx[i][j] = 1;
-			else
-				mtx[i][j] = 0;
-		}
-	}
+	return hint = h;
+}
 
-	const int c_cnt[4] = { 0, 1, 2, 3 };
-	int cnt[4] = { 0, 1, 2, 3 };
-	l = digraph_get_paths (mtx, 4, cnt[0], cnt[1], cnt[2], cnt[3]);
-	while (true) {
-new_paths:
-		for (vec_iter = l->begin (); ; vec_iter++) {
-			if (vec_iter == l->end ())
-				return;
-			while (vec_iter != l->end ()) {
-				for (i = 0; i < 4; i++) {
-					if (!i)
-						iter = get_nth_iter (hlst, (*vec_iter).name[(*vec_iter).a]);
-					else if (i == 1)
-						iter = get_nth_iter (hlst, (*vec_iter).name[(*vec_iter).b]);
-					else if (i == 2)
-						iter = get_nth_iter (hlst, (*vec_iter).name[(*vec_iter).c]);
-					else if (i == 3)
-						iter = get_nth_iter (hlst, (*vec_iter).name[(*vec_iter).d]);
-					if (iter == hlst.end ())
-						break;
-					for (int t = 0; t < 6; t++)
-						standard_solution[i + 2][t].shape = (shape_t) (*iter)[t];
-					if (!(err = is_valid (&row, &col, &nsuns, &nmoons, true)))
-						return;
-				}
-				vec_iter++;
-			};
-
-			for (j = 3; j > -1; ) {
-				if (cnt[j] < (int) hlst.size ()) {
-					cnt[j]++;
-					l = digraph_get_paths (mtx, 4, cnt[0], cnt[1], cnt[2], cnt[3]);
-					goto new_paths;
-				} else {
-					cnt[j] = c_cnt[j];
-					j--;
-				}
-			}
-			return;
-		}
-	};
+hint_t Board::get_hint () const
+{
+	return hint;
 }
 
-void Board::print (bool is_testing, bool display_values, int n_step)
+/*
+ * Ask the monitor whether the guess can still be completed, once per move.
+ * monitor_ready_cb () runs when the answer is there, and get_completion ()
+ * stays MONITOR_UNKNOWN until then
+ */
+void Board::check_completion ()
 {
-	int i, j, step;
-	typedef enum { COLOR_RED = 0, COLOR_YELLOW, COLOR_WHITE,
-			COLOR_BLACK_FG_YELLOW_BG, COLOR_WHITE_FG_BLUE_BG,
-			COLOR_RED_FG_WHITE_BG, COLOR_NORMAL } color_t;
-	std::string esc_seq[7] = {
-				"\033[01;40;31m",
-				"\033[01;40;33m",
-				"\033[01;40;37m",
-				"\033[00;43;30m",
-				"\033[01;44;37m",
-				"\033[01;47;31m",
-				"\033[00m",
-	};
+	puzzle_rec_t rec;
+	validate_cons_t cons;
 
-	if (!is_testing || test.get_total_steps_to_parse () > 0x40)
-		return;
-	for (step = 0; step < test.get_total_steps_to_parse (); step++)
-		for (i = 0; i < 6; i++)
-			for (j = 0; j < 6; j++)
-				debug[step][i][j].clear ();
+	save_puzzle (&rec);
+	validate_get_cons (&rec, &cons);
+	monitor_check (search_key (&rec), filled_mask, get_moons (), &cons, monitor_ready_cb);
+}
 
-	step = n_step;
-	if (display_values)
-		std::cout << "step n = " << step << std::endl;
-	for (i = 0; i < 6; i++) {
-		for (j = 0; j < 6; j++) {
-			if (user_guess[i][j].shape == SHAPE_SUN) {
-				if (user_guess[i][j].flags.claim_for_hor_hatching || user_guess[i][j].flags.claim_for_ver_hatching) {
-					debug[step][i][j] = esc_seq[COLOR_RED];
-					if (user_guess[i][j].flags.imm) {
-						debug[step][i][j].clear ();
-						debug[step][i][j] = esc_seq[COLOR_RED_FG_WHITE_BG];
-					}
-				} else {
-					if (user_guess[i][j].flags.imm)
-						debug[step][i][j] = esc_seq[COLOR_BLACK_FG_YELLOW_BG];
-					else
-						debug[step][i][j] = esc_seq[COLOR_YELLOW];
-				}
-				debug[step][i][j] += "*";
-				debug[step][i][j] += esc_seq[COLOR_NORMAL];
-				if (display_values)
-					std::cout << debug[step][i][j] << " ";
-			} else if (user_guess[i][j].shape == SHAPE_MOON) {
-				if (user_guess[i][j].flags.claim_for_hor_hatching || user_guess[i][j].flags.claim_for_ver_hatching) {
-					debug[step][i][j] = esc_seq[COLOR_RED];
-					if (user_guess[i][j].flags.imm) {
-						debug[step][i][j].clear ();
-						debug[step][i][j] = esc_seq[COLOR_RED_FG_WHITE_BG];
-					}
-				} else {
-					if (user_guess[i][j].flags.imm)
-						debug[step][i][j] = esc_seq[COLOR_WHITE_FG_BLUE_BG];
-					else
-						debug[step][i][j] = esc_seq[COLOR_WHITE];
-				}
-				debug[step][i][j] += "D";
-				debug[step][i][j] += esc_seq[COLOR_NORMAL];
-				if (display_values)
-					std::cout << debug[step][i][j] << " ";
-			} else {
-				debug[step][i][j] += "_";
-				debug[step][i][j] += esc_seq[COLOR_NORMAL];
-				if (display_values)
-					std::cout << debug[step][i][j] << " ";
-			}
-		}
-		if (display_values)
-			std::cout << std::endl;
-	}
-	if (display_values)
-		std::cout << std::endl;
+monitor_status_t Board::get_completion () const
+{
+	puzzle_rec_t rec;
+
+	save_puzzle (&rec);
+	return monitor_get_status (search_key (&rec));
 }
 
-std::string Board::get_debug (int n_step, int row, int col) const
+// The same guess on another board is not the same search, and 0 is no key
+uint64_t Board::search_key (const puzzle_rec_t *rec) const
 {
-	if (n_step >= test.get_total_steps_to_parse () || row > 5 || col > 5)
-		return "";
+	uint64_t key = user_hash ^ zobrist_mix (solution_hash ^ rec->edges_lo ^ ((uint64_t) rec->edges_hi << 24));
 
-	return debug[n_step][row][col];
+	return key + !key;
 }
 
-bool Board::is_immutable (int n) const
+// Frame the cell of the last hint with the color of the shape it should hold
+void Board::draw_hint ()
 {
-	for (int i = 0; i < 6; i++)
-		for (int j = 0; j < 6; j++)
-			if (standard_solution[i][j].ncell == n && standard_solution[i][j].flags.imm)
-				return true;
-	return false;
+	struct _GdkRGBA color[2] = {	{ 0.7, 0.7, 0.2, 1.0, },
+					{ 0.8, 0.8, 0.8, 1.0, },
+	};
+
+	if (hint.rule < HINT_CONSTRAINT)
+		return;
+
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
+	cairo_save (cr);
+	gdk_cairo_set_source_rgba (cr, &color[hint.shape]);
+	cairo_set_line_width (cr, 4 * x_scale);
+	cairo_rectangle (cr, ((hint.ncell % 6) * 80 + 6) * x_scale, ((hint.ncell / 6) * 80 + 6) * y_scale, 68 * x_scale, 68 * y_scale);
+	cairo_stroke (cr);
+	cairo_restore (cr);
 }
 
 void Board::set_immutable_cells (int *imm)
 {
+	TRACE_SCOPE (TRACE_SET_IMMUTABLE_CELLS);
+	int n;
+	uint64_t m;
+
 	for (int i = 0; i < 6; i++) {
 		standard_solution[imm[i] / 6][imm[i] % 6].flags.imm = 1;
 		user_guess[imm[i] / 6][imm[i] % 6].flags.imm = 1;
+		imm_mask |= CELL_BIT (imm[i]);
 	}
 
-	for (int i = 0; i < 6; i++) {
-		for (int j = 0; j < 6; j++) {
-			if (standard_solution[i][j].flags.imm) {
-				user_guess[i][j].ncell = i * 6 + j;
-				user_guess[i][j].shape = standard_solution[i][j].shape;
-				user_guess[i][j].flags.imm = 1;
-			}
-		}
+	for (m = imm_mask; m; ) {
+		n = pop_cell (&m);
+		user_guess[n / 6][n % 6].ncell = n;
+		user_guess[n / 6][n % 6].shape = standard_solution[n / 6][n % 6].shape;
+		user_guess[n / 6][n % 6].flags.imm = 1;
 	}
+	filled_mask |= imm_mask;
+	rehash ();
 }
 
+/*
+ * One cell per row and column means a permutation of the columns: shuffle
+ * them, then pick ngivens of the rows with a partial shuffle as well
+ */
 void Board::set_immutable_cells ()
 {
-	int i, j, rnd;
-	int row, col;
-	bool ins;
-	std::set<int> s;
-	std::set<int>::iterator iter;
+	TRACE_SCOPE (TRACE_SET_IMMUTABLE_CELLS);
+	int i, j, tmp;
+	int rows[6] = { 0, 1, 2, 3, 4, 5 };
+	int cols[6] = { 0, 1, 2, 3, 4, 5 };
 
 	if (this->testing)
 		return;
 
-	while (true) {
-		rnd = rand () % 36;
-		if (!s.size ()) {
-			s.insert (rnd);
-			i = 1;
-		}
-		for (i = 0, iter = s.begin (); iter != s.end (); iter++, i++) {
-			row = rnd / 6;
-			col = rnd % 6;
-			if (*iter / 6 != row && *iter % 6 != col) {
-				ins = true;
-			} else {
-				ins = false;
-				break;
-			}
+	for (i = 5; i > 0; i--) {
+		j = rand () % (i + 1);
+		tmp = cols[i];
+		cols[i] = cols[j];
+		cols[j] = tmp;
+	}
 
-			if ((unsigned) i == s.size () - 1 && ins)
-				s.insert (rnd);
-		}
-		if (s.size () == 6)
-			break;
+	for (i = 0; i < ngivens; i++) {
+		j = i + rand () % (6 - i);
+		tmp = rows[i];
+		rows[i] = rows[j];
+		rows[j] = tmp;
+		add_immutable_cell (rows[i] * 6 + cols[rows[i]]);
 	}
 
-	for (iter = s.begin (); iter != s.end (); iter++) {
-		standard_solution[*iter / 6][*iter % 6].flags.imm = 1;
-		user_guess[*iter / 6][*iter % 6].flags.imm = 1;
+#ifdef TANGORINEBA_LOG
+	if (log_enabled (LOG_LEVEL_INFO)) {
+		std::string line = std::string (__FUNCTION__) + "(): ";
+
+		for (uint64_t m = imm_mask; m; )
+			line += std::to_string (pop_cell (&m)) + ", ";
+		log_printf (LOG_LEVEL_INFO, "%s", line.c_str ());
 	}
+#endif
+}
 
-	std::cout << __FUNCTION__ << "(): ";
-	for (i = 0; i < 6; i++) {
-		for (j = 0; j < 6; j++) {
-			if (standard_solution[i][j].flags.imm) {
-				user_guess[i][j].ncell = i * 6 + j;
-				user_guess[i][j].shape = standard_solution[i][j].shape;
-				std::cout << user_guess[i][j].ncell << ", ";
-			}
-		}
+void Board::add_immutable_cell (int n)
+{
+	standard_solution[n / 6][n % 6].flags.imm = 1;
+	user_guess[n / 6][n % 6].ncell = n;
+	user_hash ^= zobrist_key (n, user_guess[n / 6][n % 6].shape) ^ zobrist_key (n, standard_solution[n / 6][n % 6].shape);
+	user_guess[n / 6][n % 6].shape = standard_solution[n / 6][n % 6].shape;
+	user_guess[n / 6][n % 6].flags.imm = 1;
+	imm_mask |= CELL_BIT (n);
+	filled_mask |= CELL_BIT (n);
+	hint_lines.dirty |= (1 << (n / 6)) | (1 << (6 + n % 6));
+}
+
+/*
+ * While the solver finds another solution, turn one of the cells where it
+ * differs from the standard solution into an immutable cell. That rules
+ * out at least that solution each time, so it ends in a few rounds
+ */
+void Board::make_unique ()
+{
+	int k, n = 0;
+	uint64_t diff, sols[2];
+	puzzle_rec_t rec;
+
+	while (true) {
+		save_puzzle (&rec);
+		if (solver_count (&rec, 2, sols) < 2)
+			break;
+
+		diff = (sols[0] ^ rec.solution) ? sols[0] ^ rec.solution : sols[1] ^ rec.solution;
+		for (k = rand () % __builtin_popcountll (diff); k >= 0; k--)
+			n = pop_cell (&diff);
+		add_immutable_cell (n);
+		LOG_PRINTF (LOG_LEVEL_INFO, "%s(): %d", __FUNCTION__, n);
 	}
-	std::cout << std::endl;
 }
 
 void Board::draw_immutable_cells ()
 {
 	int i;
+	uint64_t m;
 	struct _GdkRGBA darkercolor = { 0.0, 0.1, 0.2, 1.0 };
 
-	double x_scale = gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	cairo_save (cr);
 	gdk_cairo_set_source_rgba (cr, &darkercolor);
-	for (i = 0; i < 36; i++) {
-		if (standard_solution[i / 6][i % 6].flags.imm) {
-			cairo_rectangle (cr, ((i % 6) * 80 + 2) * x_scale, ((i / 6) * 80 + 2) * y_scale, 76 * x_scale, 76 * y_scale);
-			cairo_fill (cr);
-			draw_shape (i / 6, i % 6, standard_solution[i / 6][i % 6].shape);
-		}
+	for (m = imm_mask; m; ) {
+		i = pop_cell (&m);
+		cairo_rectangle (cr, ((i % 6) * 80 + 2) * x_scale, ((i / 6) * 80 + 2) * y_scale, 76 * x_scale, 76 * y_scale);
+		cairo_fill (cr);
+		draw_shape (i / 6, i % 6, standard_solution[i / 6][i % 6].shape);
 	}
 	cairo_restore (cr);
 }
 
 void Board::decode_flags (shape_info_t& ref)
 {
-	if (ref.flags.top) {
-		std::cout << ref.ncell << ": top ";
-		if (ref.flags.top_equal)
-			std::cout << "(=), ";
-		else
-			std::cout << "(x), ";
-	}
-
-	if (ref.flags.right) {
-		std::cout << ref.ncell << ": right, ";
-		if (ref.flags.right_equal)
-			std::cout << "(=), ";
-		else
-			std::cout << "(x), ";
-	}
-
-	if (ref.flags.bottom) {
-		std::cout << ref.ncell << ": bottom, ";
-		if (ref.flags.bottom_equal)
-			std::cout << "(=), ";
-		else
-			std::cout << "(x), ";
-	}
-
-	if (ref.flags.left) {
-		std::cout << ref.ncell << ": left, ";
-		if (ref.flags.left_equal)
-			std::cout << "(=), ";
-		else
-			std::cout << "(x), ";
-	}
-
-	std::cout << std::endl;
+#ifdef TANGORINEBA_LOG
+	std::string line;
+
+	if (ref.flags.top)
+		line += std::to_string (ref.ncell) + (ref.flags.top_equal ? ": top (=), " : ": top (x), ");
+	if (ref.flags.right)
+		line += std::to_string (ref.ncell) + (ref.flags.right_equal ? ": right, (=), " : ": right, (x), ");
+	if (ref.flags.bottom)
+		line += std::to_string (ref.ncell) + (ref.flags.bottom_equal ? ": bottom, (=), " : ": bottom, (x), ");
+	if (ref.flags.left)
+		line += std::to_string (ref.ncell) + (ref.flags.left_equal ? ": left, (=), " : ": left, (x), ");
+	LOG_PRINTF (LOG_LEVEL_DEBUG, "%s", line.c_str ());
+#endif
 }
 
 void Board::set_constraints (cons_t *cons)
 {
+	TRACE_SCOPE (TRACE_SET_CONSTRAINTS);
 	int i;
 	std::set<shape_info_t> s;
 	std::set<shape_info_t>::iterator iter;
@@ -1304,120 +1554,53 @@ void Board::set_constraints (cons_t *cons)
 	}
 }
 
+/*
+ * Pick PUZZLE_MAX_CONS distinct interior edges with a partial Fisher-Yates
+ * shuffle, so that it takes a fixed number of rand () calls. Each
+ * constraint is then attached to either of the cells sharing the edge
+ */
 void Board::set_constraints ()
 {
-	int dir;
-	int _u[2] = { 0 };
-	std::set<shape_info_t> s;
-	std::set<shape_info_t>::iterator iter;
-
-	std::cout << __FUNCTION__ << "(): ";
-	while (true) {
-new_rand:
-		_u[0] = rand () % 36;
-		dir = rand () & 3;
-		shape_info_t& ref = standard_solution[_u[0] / 6][_u[0] % 6];
-		if (dir == 0) {
-			if (_u[0] < 6)
-				goto new_rand;
-			_u[1] = _u[0] - 6;
-			if (standard_solution[_u[1] / 6][_u[1] % 6].flags.bottom)
-				goto new_rand;
-			if (ref.shape == standard_solution[_u[1] / 6][_u[1] % 6].shape) {
-				ref.flags.top = 1;
-				ref.flags.top_equal = 1;
-			} else {
-				ref.flags.top = 1;
-				ref.flags.top_equal = 0;
-			}
-			s.insert (ref);
-		} else if (dir == 1) {
-			if ((_u[0] + 1) % 6 == 0)
-				goto new_rand;
-			_u[1] = _u[0] + 1;
-			if (standard_solution[_u[1] / 6][_u[1] % 6].flags.left)
-				goto new_rand;
-			if (ref.shape == standard_solution[_u[1] / 6][_u[1] % 6].shape) {
-				ref.flags.right = 1;
-				ref.flags.right_equal = 1;
+	TRACE_SCOPE (TRACE_SET_CONSTRAINTS);
+	int i, j, tmp, cell_0, cell_1;
+	int edges[PUZZLE_NUM_EDGES];
+	bool equal;
+
+	for (i = 0; i < PUZZLE_NUM_EDGES; i++)
+		edges[i] = i;
+
+	LOG_PRINTF (LOG_LEVEL_INFO, "%s(): ", __FUNCTION__);
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		j = i + rand () % (PUZZLE_NUM_EDGES - i);
+		tmp = edges[i];
+		edges[i] = edges[j];
+		edges[j] = tmp;
+
+		puzzle_get_edge_cells (edges[i], &cell_0, &cell_1);
+		shape_info_t& r0 = standard_solution[cell_0 / 6][cell_0 % 6];
+		shape_info_t& r1 = standard_solution[cell_1 / 6][cell_1 % 6];
+		equal = r0.shape == r1.shape;
+		if (rand () & 1) {
+			if (edges[i] < 30) {
+				r0.flags.right = 1;
+				r0.flags.right_equal = equal;
 			} else {
-				ref.flags.right = 1;
-				ref.flags.right_equal = 0;
+				r0.flags.bottom = 1;
+				r0.flags.bottom_equal = equal;
 			}
-			s.insert (ref);
-		} else if (dir == 2) {
-			if (_u[0] >= 30)
-				goto new_rand;
-			_u[1] = _u[0] + 6;
-			if (standard_solution[_u[1] / 6][_u[1] % 6].flags.top)
-				goto new_rand;
-			if (ref.shape == standard_solution[_u[1] / 6][_u[1] % 6].shape) {
-				ref.flags.bottom = 1;
-				ref.flags.bottom_equal = 1;
-			} else {
-				ref.flags.bottom = 1;
-				ref.flags.bottom_equal = 0;
-			}
-			s.insert (ref);
-		} else if (dir == 3) {
-			if (!_u[0] || (_u[0] - 1) % 6 == 5)
-				goto new_rand;
-			_u[1] = _u[0] - 1;
-			if (standard_solution[_u[1] / 6][_u[1] % 6].flags.right)
-				goto new_rand;
-			if (ref.shape == standard_solution[_u[1] / 6][_u[1] % 6].shape) {
-				ref.flags.left = 1;
-				ref.flags.left_equal = 1;
+			user_guess[cell_0 / 6][cell_0 % 6].flags = r0.flags;
+			LOG_PRINTF (LOG_LEVEL_INFO, "%d, %s, %s", cell_0, edges[i] < 30 ? "RIGHT" : "BOTTOM", equal ? "=" : "x");
+		} else {
+			if (edges[i] < 30) {
+				r1.flags.left = 1;
+				r1.flags.left_equal = equal;
 			} else {
-				ref.flags.left = 1;
-				ref.flags.left_equal = 0;
+				r1.flags.top = 1;
+				r1.flags.top_equal = equal;
 			}
-			s.insert (ref);
-		}
-
-		if (s.size () == 8)
-			break;
-	}
-
-	std::string flags;
-	std::cout << std::endl;
-	for (iter = s.begin (); iter != s.end (); iter++) {
-		standard_solution[iter->ncell / 6][iter->ncell % 6].flags = iter->flags;
-		user_guess[iter->ncell / 6][iter->ncell % 6].flags = iter->flags;
-		std::cout << iter->ncell << ", ";
-		if (iter->flags.top) {
-			flags += "TOP, ";
-			if (iter->flags.top_equal)
-				flags += "=";
-			else
-				flags += "x";
+			user_guess[cell_1 / 6][cell_1 % 6].flags = r1.flags;
+			LOG_PRINTF (LOG_LEVEL_INFO, "%d, %s, %s", cell_1, edges[i] < 30 ? "LEFT" : "TOP", equal ? "=" : "x");
 		}
-
-		if (iter->flags.right) {
-			flags += "RIGHT, ";
-			if (iter->flags.right_equal)
-				flags += "=";
-			else
-				flags += "x";
-		}
-
-		if (iter->flags.bottom) {
-			flags += "BOTTOM, ";
-			if (iter->flags.bottom_equal)
-				flags += "=";
-			else
-				flags += "x";
-		}
-
-		if (iter->flags.left) {
-			flags += "LEFT, ";
-			if (iter->flags.left_equal)
-				flags += "=";
-			else
-				flags += "x";
-		}
-		std::cout << flags << std::endl;
-		flags.clear ();
 	}
 }
 
@@ -1426,8 +1609,8 @@ void Board::draw_constraints ()
 	int i;
 	struct _GdkRGBA color = { 0.0, 1.0, 0.0, 1.0 };
 
-	double x_scale = gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
-	double y_scale = gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+	double x_scale = get_x_scale ();
+	double y_scale = get_y_scale ();
 	cairo_save (cr);
 	gdk_cairo_set_source_rgba (cr, &color);
 	for (i = 0; i < 36; i++) {
@@ -1500,6 +1683,47 @@ void Board::draw_constraints ()
 	cairo_restore (cr);
 }
 
+/*
+ * Draw the board as it is to be played (empty cells, immutable cells and
+ * constraints) on @cr, which is @width x @height px. It only uses the board
+ * itself, so boards on different threads can be rendered at the same time
+ * as long as each one has its own surface
+ */
+void Board::render (cairo_t *cr, int width, int height)
+{
+	struct _GdkRGBA bgcolor = { 0.2, 0.3, 0.4, 1.0 };
+
+	this->cr = cr;
+	surface_width = width;
+	surface_height = height;
+
+	cairo_save (cr);
+	gdk_cairo_set_source_rgba (cr, &bgcolor);
+	cairo_paint (cr);
+	cairo_restore (cr);
+	for (int i = 0; i < 36; i++)
+		draw_shape (i / 6, i % 6, SHAPE_EMPTY);
+	draw_immutable_cells ();
+	draw_constraints ();
+}
+
+// The original size of the window is 480x480 px
+double Board::get_x_scale () const
+{
+	if (surface_width)
+		return surface_width / 480.0;
+
+	return gtk_widget_get_allocated_width (GTK_WIDGET (da)) / 480.0;
+}
+
+double Board::get_y_scale () const
+{
+	if (surface_height)
+		return surface_height / 480.0;
+
+	return gtk_widget_get_allocated_height (GTK_WIDGET (da)) / 480.0;
+}
+
 bool Board::is_configured () const
 {
 	return this->configured;
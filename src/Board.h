@@ -23,6 +23,11 @@
 #include <string>
 #include <gtk/gtk.h>
 #include "common.h"
+#include "Puzzle.h"
+#include "Journal.h"
+#include "Hint.h"
+#include "Monitor.h"
+#include "Validate.h"
 
 typedef struct shape_info_st {
 	int ncell;
@@ -30,6 +35,14 @@ typedef struct shape_info_st {
 	bm_flags_t flags;
 } shape_info_t;
 
+// Read-only view over cells of the board, without copying them
+typedef struct cell_view_st {
+	const shape_info_t *first;
+	int stride;		// 1 for rows and the whole board, 6 for columns
+	int size;
+	const shape_info_t& operator[] (int n) const { return first[n * stride]; }
+} cell_view_t;
+
 class Board {
 public:
 	typedef enum { ROW = 0, COL } line_type_check;
@@ -42,18 +55,32 @@ public:
 
 	Board ();
 	Board (bool testing, std::string test_filename);
+	explicit Board (const puzzle_rec_t *rec);
 	Board (Board&) = delete;
 	Board (Board&&) = delete;
 	Board& operator= (Board&) = delete;
 	~Board ();
 
 	void new_game ();
+	void new_daily_game ();
+	void generate (int seed);
+	void play_puzzle (const puzzle_rec_t *rec);
+	void load_puzzle (const puzzle_rec_t *rec);
+	void save_puzzle (puzzle_rec_t *rec) const;
+	void restore_guess (uint64_t filled, uint64_t moons);
+	void journal_move (journal_type_t type, int ncell);
+	bool apply_journal_move (const journal_rec_t *rec);
+	bool replay_journal (const journal_t *j, uint32_t nmoves);
 	void set_seed (int seed);
+	void set_givens (int count, bool unique);
 	void draw_shape (int nrow, int ncol, shape_t shape);
 	void draw_cells (cairo_t *cr);
-	bool can_draw_hatching (int ncell);
+	bool can_draw_hatching (int ncell) const;
 	void set_hatching (int ncell, bool hor);
 	void clear_hatching (int ncell, bool hor);
+	void set_hatching_mask (uint64_t mask, bool hor);
+	void clear_hatching_mask (uint64_t mask, bool hor);
+	uint64_t get_hatching () const;
 	void draw_hatching (int ncell);
 	void draw_hatching_on_immutable ();
 	bool get_game_over ();
@@ -65,6 +92,13 @@ public:
 	shape_info_t get_shape_status (int ncell) const;
 	shape_info_t get_user_guess (int ncell) const;
 	shape_info_t get_standard_solution (int ncell) const;
+	shape_t get_user_shape (int ncell) const;
+	shape_t get_solution_shape (int ncell) const;
+	const shape_info_t& view_user_guess (int ncell) const;
+	const shape_info_t& view_standard_solution (int ncell) const;
+	cell_view_t view_row (int nrow, bool std) const;
+	cell_view_t view_col (int ncol, bool std) const;
+	cell_view_t view_board (bool std) const;
 	void set_shape_status (int ncell, shape_t sh);
 	void set_user_guess (int ncell, shape_t sh, bm_flags_t flags);
 	int get_num_hsuns (int row, bool std);
@@ -73,20 +107,25 @@ public:
 	int get_num_vmoons (int col, bool std);
 	int get_third_adjacent (int row, int col, line_type_check check, bool std);
 	int is_valid (int *row, int *col, int *nsuns, int *nmoons, bool std);
-
-	void validate_row_three_adjs (int nrow);
-	void validate_row_diff_num_of_shapes (int nrow);
-	void validate_row_constraints (int nrow);
 	void validate_row (int nrow);
-	void validate_col_three_adjs (int ncol);
-	void validate_col_diff_num_of_shapes (int ncol);
-	void validate_col_constraints (int ncol);
 	void validate_col (int ncol);
+	uint64_t get_conflicts (int rule) const;
 
 	void prepare ();
 	void print (bool is_testing, bool display_values, int n_step);
-	std::string get_debug (int n_step, int row, int col) const;
 	bool is_immutable (int n) const;
+	uint64_t get_immutable () const;
+	uint64_t get_filled () const;
+	int get_num_filled () const;
+	uint64_t get_moons () const;
+	uint64_t get_user_hash () const;
+	uint64_t get_solution_hash () const;
+	bool can_be_completed () const;
+	hint_t next_hint ();
+	hint_t get_hint () const;
+	void draw_hint ();
+	void check_completion ();
+	monitor_status_t get_completion () const;
 	void set_immutable_cells (int *imm);
 	void set_immutable_cells ();
 	void draw_immutable_cells ();
@@ -94,19 +133,44 @@ public:
 	void set_constraints (cons_t *cons);
 	void set_constraints ();
 	void draw_constraints ();
+	void render (cairo_t *cr, int width, int height);
 	bool is_configured () const;
 	bool is_testing () const;
 
 private:
+	void clear_cells ();
+	void restart ();
+	void add_immutable_cell (int n);
+	void make_unique ();
+	void rehash ();
+	uint64_t search_key (const puzzle_rec_t *rec) const;
+	void check_line (int line);
+	double get_x_scale () const;
+	double get_y_scale () const;
+
 	cairo_t *cr;
+	int surface_width;		// Size of the surface given to render (), 0 to draw on da
+	int surface_height;
 	shape_info_t standard_solution[6][6];
 	shape_info_t user_guess[6][6];
+	uint64_t hor_hatching;		// Cells of the user's guess hatched by row checks
+	uint64_t ver_hatching;		// ... and by column checks
+	uint8_t conflicts[VALIDATE_NUM_RULES][12];	// Cells of each line to blame, see check_line ()
+	uint64_t imm_mask;		// Immutable cells
+	uint64_t filled_mask;		// Cells of the user's guess holding a shape
+	uint64_t user_hash;		// Zobrist hash of the user's guess, see src/Zobrist.cc
+	uint64_t solution_hash;		// ... and of the standard solution
+	hint_lines_t hint_lines;	// Cells forced on each line, see src/Hint.cc
+	hint_t hint;			// Last hint given, until the next move
+	journal_writer_t *journal;	// Created on the first move, see journal_move ()
+	int64_t journal_t0;		// Monotonic time the game started at
 	bool configured;
 	bool testing;
 	std::string test_filename;
 	std::string exp_filename;
 	int seed;
-	std::string debug[0x40][6][6];
+	int ngivens;			// Immutable cells placed by set_immutable_cells ()
+	bool unique_givens;		// Add givens until there's a single solution
 	bool game_over;
 };
 
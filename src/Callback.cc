@@ -26,6 +26,8 @@
 #include "common.h"
 #include "Board.h"
 #include "Stack.h"
+#include "Trace.h"
+#include "Hud.h"
 #include "../test/Test.h"
 
 typedef struct region_st {
@@ -38,14 +40,14 @@ typedef struct region_st {
 extern class Test test;
 extern GtkWidget *main_window, *da, *time_da, *undo_btn, *redo_btn;
 bool are_there_pending_events = false;
+static bool hint_wanted = false;	// The hint button was pressed while searching
+bool monitor_moves = false;		// Set with `--monitor'
+static bool board_stuck = false;	// The monitor found that the guess can't be completed
+hud_t *hud = nullptr;			// Set with `--hud'
 std::list<pending_events_t> redraw_cells;
 class Stack undo;
 class Stack redo;
 
-// Maybe "setlist" becomes a private member of a future class Window,
-// with getters and setters handling it, but it works fine so far
-std::set<int> setlist;
-
 int game_over_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data);
 
 class CallbackData {
@@ -471,10 +473,55 @@ int draw_timer_cb (GtkWidget *widget, cairo_t *cr, void *user_data)
 	return 0;
 }
 
+// A move makes the last hint (or the one still being searched) useless
+static void forget_hint ()
+{
+	hint_wanted = false;
+	gtk_widget_set_tooltip_text (da, nullptr);
+}
+
+/*
+ * With `--monitor', every move gets checked in the background, and the
+ * board is framed in red by draw_cb () once it can no longer be solved
+ */
+static void watch_board ()
+{
+	if (monitor_moves)
+		board.check_completion ();
+}
+
+int monitor_ready_cb (gpointer data)
+{
+	monitor_status_t status = board.get_completion ();
+
+	// Answers for boards the player already moved away from are dropped
+	if (status != MONITOR_UNKNOWN && board_stuck != (status == MONITOR_STUCK)) {
+		board_stuck = (status == MONITOR_STUCK);
+		are_there_pending_events = true;
+		gtk_widget_queue_draw (da);
+	}
+
+	return false;
+}
+
+static void draw_stuck_frame (cairo_t *cr)
+{
+	struct _GdkRGBA color = { 0.8, 0.2, 0.2, 1.0 };
+	double x_scale = gtk_widget_get_allocated_width (da) / 480.0;
+	double y_scale = gtk_widget_get_allocated_height (da) / 480.0;
+
+	cairo_save (cr);
+	gdk_cairo_set_source_rgba (cr, &color);
+	cairo_set_line_width (cr, 6 * x_scale);
+	cairo_rectangle (cr, 3 * x_scale, 3 * y_scale, 474 * x_scale, 474 * y_scale);
+	cairo_stroke (cr);
+	cairo_restore (cr);
+}
+
 void clear_game_cb (GtkButton *btn)
 {
 	for (int i = 0; i < 36; i++) {
-		shape_info_t r = board.get_standard_solution (i);
+		const shape_info_t& r = board.view_standard_solution (i);
 		// We must to make sure that shapes on immutable cells are
 		// rendered ok, as well as all of those cells which are not
 		// immutable. This is really important since it fixes a
@@ -488,8 +535,10 @@ void clear_game_cb (GtkButton *btn)
 		board.clear_hatching (i, true);
 		board.clear_hatching (i, false);
 	}
+	board.journal_move (JOURNAL_CLEAR, 0);
+	forget_hint ();
+	watch_board ();
 	redraw_cells.clear ();
-	setlist.clear ();
 	are_there_pending_events = true;
 	undo.remove_downwards (0);
 	redo.remove_downwards (0);
@@ -500,14 +549,15 @@ void clear_game_cb (GtkButton *btn)
 
 void new_game_cb (GtkButton *btn)
 {
+	forget_hint ();
 	redraw_cells.clear ();
-	setlist.clear ();
 	are_there_pending_events = true;
 	undo.remove_downwards (0);
 	redo.remove_downwards (0);
 	gtk_widget_set_sensitive (undo_btn, false);
 	gtk_widget_set_sensitive (redo_btn, false);
 	board.new_game ();
+	board_stuck = false;
 }
 
 void undo_cb (GtkButton *btn)
@@ -528,10 +578,11 @@ void undo_cb (GtkButton *btn)
 	else
 		new_shape = SHAPE_MOON;
 	new_flags = undo.top().pe.flags;
-	new_flags.claim_for_hor_hatching = 0;
-	new_flags.claim_for_ver_hatching = 0;
 
 	board.set_user_guess (undo.top().pe.ncell, new_shape, new_flags);
+	board.journal_move (JOURNAL_UNDO, undo.top().pe.ncell);
+	forget_hint ();
+	watch_board ();
 	pending_event.pe.ncell = undo.top().pe.ncell;
 	pending_event.pe.shape = new_shape;
 	pending_event.pe.flags = new_flags;
@@ -563,10 +614,11 @@ void redo_cb (GtkButton *btn)
 	else
 		new_shape = SHAPE_SUN;
 	new_flags = redo.top().pe.flags;
-	new_flags.claim_for_hor_hatching = 0;
-	new_flags.claim_for_ver_hatching = 0;
 
 	board.set_user_guess (redo.top().pe.ncell, new_shape, new_flags);
+	board.journal_move (JOURNAL_REDO, redo.top().pe.ncell);
+	forget_hint ();
+	watch_board ();
 	pending_event.pe.ncell = redo.top().pe.ncell;
 	pending_event.pe.shape = new_shape;
 	pending_event.pe.flags = new_flags;
@@ -580,6 +632,29 @@ void redo_cb (GtkButton *btn)
 	gtk_widget_queue_draw (GTK_WIDGET (da));
 }
 
+/*
+ * The cell of the hint gets framed on the board, and the rule behind it is
+ * shown as the tooltip of the board. Hints that need a search are shown
+ * by hint_ready_cb () instead, unless the player moves in the meantime
+ */
+void hint_cb (GtkButton *btn)
+{
+	hint_t hint = board.next_hint ();
+
+	hint_wanted = (hint.rule == HINT_PENDING);
+	gtk_widget_set_tooltip_text (da, hint_describe (hint.rule));
+	are_there_pending_events = true;
+	gtk_widget_queue_draw (da);
+}
+
+int hint_ready_cb (gpointer data)
+{
+	if (hint_wanted)
+		hint_cb (nullptr);
+
+	return false;
+}
+
 int configure_cb (GtkWidget *widget, GdkEventConfigure *event, void *data)
 {
 	double x_scale = gtk_widget_get_allocated_width (da) / 480.0;
@@ -596,14 +671,28 @@ int configure_cb (GtkWidget *widget, GdkEventConfigure *event, void *data)
 
 int draw_cb (GtkWidget *widget, cairo_t *cr, void *user_data)
 {
+	TRACE_SCOPE (TRACE_DRAW_CB);
 	struct _GdkRGBA bgcolor = { 0.2, 0.3, 0.4, 1.0 };
 	std::list<pending_events_t>::iterator iter;
+	bool configured = board.is_configured ();
+
+	// A refresh of the HUD alone leaves the board as it is
+	if (hud && !are_there_pending_events && hud_clip_is_inside (cr)) {
+		hud_draw (hud, cr);
+		return 0;
+	}
 
+	if (hud)
+		hud_begin_frame (hud, gtk_widget_get_frame_clock (widget), cr);
 	cairo_save (cr);
 	cbdata.set_cr (cr);
 	gdk_cairo_set_source_rgba (cr, &bgcolor);
 	cairo_paint (cr);
 	board.draw_cells (cr);
+
+	// A new game only gets its givens and constraints on its first draw
+	if (!configured && board.is_configured ())
+		watch_board ();
 	if (are_there_pending_events) {
 		for (iter = redraw_cells.begin (); iter != redraw_cells.end (); iter++) {
 			board.draw_immutable_cells ();
@@ -623,11 +712,32 @@ int draw_cb (GtkWidget *widget, cairo_t *cr, void *user_data)
 		}
 	}
 	board.draw_constraints ();
+	board.draw_hint ();
+	if (board_stuck)
+		draw_stuck_frame (cr);
 	cairo_restore (cr);
 
+	// The HUD itself is not part of the time it shows
+	if (hud) {
+		hud_end_frame (hud);
+		hud_draw (hud, cr);
+	}
+
 	return 0;
 }
 
+/*
+ * The frame clock keeps ticking for the HUD, so that the frame rate is the
+ * one of the display and the latency of a click shows up as soon as its
+ * frame is presented. Only the box of the HUD gets drawn again for that
+ */
+int hud_tick_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data)
+{
+	if (hud_tick (hud, frame_clock))
+		gtk_widget_queue_draw_area (widget, 0, 0, HUD_WIDTH, HUD_HEIGHT);
+	return true;
+}
+
 int game_over_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data)
 {
 	static bool go_down = false;
@@ -650,16 +760,18 @@ int game_over_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data)
 
 bool button_press_cb (GtkWidget *widget, GdkEventButton *event, void *user_data)
 {
+	TRACE_SCOPE (TRACE_BUTTON_PRESS_CB);
 	int err, row = -1, col = -1, nsuns = -1, nmoons = -1;
 	shape_t new_guess = SHAPE_EMPTY;
 	pending_events_t pending_event;
 	history_t stk_event;
-	std::set<int>::iterator iter;
 
+	if (hud)
+		hud_click (hud, event->time);
 	for (int i = 0; i < 36; i++) {
 		if (event->x > cbdata.get_region (i)->x0 && event->x < cbdata.get_region (i)->x1 &&
 		    event->y > cbdata.get_region (i)->y0 && event->y < cbdata.get_region (i)->y1) {
-			switch (board.get_user_guess (i).shape) {
+			switch (board.get_user_shape (i)) {
 			case SHAPE_SUN:
 				new_guess = SHAPE_MOON;
 				break;
@@ -672,12 +784,14 @@ bool button_press_cb (GtkWidget *widget, GdkEventButton *event, void *user_data)
 			};
 
 			if (!board.is_immutable (i)) {
+				forget_hint ();
 				are_there_pending_events = true;
 				pending_event.ncell = i;
 				pending_event.shape = new_guess;
-				pending_event.flags = board.get_standard_solution (i).flags;
+				pending_event.flags = board.view_standard_solution (i).flags;
 				board.set_user_guess (i, new_guess, pending_event.flags);
 				redraw_cells.push_back (pending_event);
+				watch_board ();
 			} else {
 				are_there_pending_events = false;
 			}
@@ -685,35 +799,22 @@ bool button_press_cb (GtkWidget *widget, GdkEventButton *event, void *user_data)
 			board.validate_row (i / 6);
 			board.validate_col (i % 6);
 			if (are_there_pending_events) {
-				if (board.get_user_guess (i).shape != SHAPE_EMPTY)
-					setlist.insert (i);
-empty_shape_erased:
-				for (iter = setlist.begin (); iter != setlist.end (); iter++) {
-					if (board.get_user_guess (*iter).shape == SHAPE_EMPTY &&
-					    !board.get_user_guess (*iter).flags.claim_for_hor_hatching &&
-					    !board.get_user_guess (*iter).flags.claim_for_ver_hatching) {
-						// Caught *iter with an empty shape! Erasing...
-						setlist.erase (iter);
-						goto empty_shape_erased;
-					}
-				}
-
+				// The board keeps track of filled cells by itself, so the
+				// game ends as soon as all of them are filled and valid.
+				// set_game_over () still refuses while a constraint is
+				// broken, and then the game goes on
 				err = board.is_valid (&row, &col, &nsuns, &nmoons, false);
-				if (setlist.size () == 30 && !err) {
-					// If we are about to end a game, we must to reset this
-					// setlist to zero amount of items because we use it as
-					// a global variable. We should do the same if we used
-					// static variables. While we're going to move to a
-					// Window class which holds much of this stuff, our
-					// approach is a little bit old-fashion now, that is, we
-					// keep using global vars inside callbacks...
-					setlist.clear ();
+				board.journal_move (JOURNAL_MOVE, i);
+				if (board.get_num_filled () == 36 && !err) {
 					board.set_game_over (true);
-					cbdata.set_game_over_id (gtk_widget_add_tick_callback (GTK_WIDGET (da), game_over_cb, nullptr, nullptr));
+					if (board.get_game_over ()) {
+						board.journal_move (JOURNAL_END, i);
+						cbdata.set_game_over_id (gtk_widget_add_tick_callback (GTK_WIDGET (da), game_over_cb, nullptr, nullptr));
+					}
 				}
 				stk_event.pe.ncell = i;
-				stk_event.pe.shape = board.get_user_guess (i).shape;
-				stk_event.pe.flags = board.get_user_guess (i).flags;
+				stk_event.pe.shape = board.view_user_guess (i).shape;
+				stk_event.pe.flags = board.view_user_guess (i).flags;
 				stk_event.uid = cbdata.get_uid ();
 				cbdata.set_uid (cbdata.get_uid () + 1);
 				undo.push (stk_event);
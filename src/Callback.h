@@ -82,8 +82,12 @@ void clear_game_cb (GtkButton *btn);
 void new_game_cb (GtkButton *btn);
 void undo_cb (GtkButton *btn);
 void redo_cb (GtkButton *btn);
+void hint_cb (GtkButton *btn);
+int hint_ready_cb (gpointer data);
+int monitor_ready_cb (gpointer data);
 int configure_cb (GtkWidget *widget, GdkEventConfigure *event, void *data);
 int draw_cb (GtkWidget *widget, cairo_t *cr, gpointer data);
+int hud_tick_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data);
 int game_over_cb (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data);
 bool button_press_cb (GtkWidget *widget, GdkEventButton *button, void *data);
 #endif
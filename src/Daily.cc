@@ -0,0 +1,180 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <cstring>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gtk/gtk.h>
+#include "common.h"
+#include "Puzzle.h"
+
+#ifndef TANGORINEBA_DAILY_SALT
+#define TANGORINEBA_DAILY_SALT	"TangorineBA"
+#endif
+
+#define DAILY_ROLLOVER_HOUR	9
+#define DAILY_CACHE_SLOTS	64
+#define DAILY_CACHE_VERSION	5
+
+typedef struct daily_entry_st {
+	int date;
+	int day;
+	puzzle_rec_t puzzle;
+} daily_entry_t;
+
+/*
+ * The cache is a single file under $XDG_CACHE_HOME/TangorineBA, mapped once
+ * in memory and shared with the kernel's page cache. The header tells us
+ * whether the file was written by a compatible build, and with the same
+ * salt, since every build with its own salt has its own boards of the day
+ * but they all share the file; otherwise we simply wipe it, since all of
+ * its contents can be regenerated from the seeds
+ */
+typedef struct daily_cache_st {
+	char magic[8];
+	int version;
+	int nslots;
+	int entry_size;
+	int salt;		// daily_get_seed (0, TANGORINEBA_DAILY_SALT), the salt itself is not kept
+	daily_entry_t slot[DAILY_CACHE_SLOTS];
+} daily_cache_t;
+
+static const char daily_magic[8] = { 'T', 'G', 'B', 'A', 'D', 'L', 'Y', '\0' };
+static daily_cache_t *cache = nullptr;
+static bool cache_unavailable = false;
+
+/*
+ * Boards are published at 09:00 a.m., local time, so before that hour we
+ * are still playing yesterday's board. @day receives the number of days
+ * since the Epoch for that date, which is handier than YYYYMMDD when
+ * computing the age of the cache entries
+ */
+int daily_get_date (time_t now, int *day)
+{
+	struct tm tm;
+	time_t t = now - DAILY_ROLLOVER_HOUR * 3600;
+
+	localtime_r (&t, &tm);
+	if (day) {
+		struct tm midnight = { };
+
+		midnight.tm_year = tm.tm_year;
+		midnight.tm_mon = tm.tm_mon;
+		midnight.tm_mday = tm.tm_mday;
+		*day = (int) (timegm (&midnight) / 86400);
+	}
+
+	return (tm.tm_year + 1900) * 10000 + (tm.tm_mon + 1) * 100 + tm.tm_mday;
+}
+
+// FNV-1a over "YYYYMMDD:salt", folded to a non-negative int for srand ()
+int daily_get_seed (int date, const char *salt)
+{
+	unsigned int hash = 2166136261u;
+	std::string key = std::to_string (date) + ":" + salt;
+
+	for (unsigned char c : key) {
+		hash ^= c;
+		hash *= 16777619u;
+	}
+
+	return (int) (hash & 0x7fffffff);
+}
+
+static daily_cache_t *daily_cache_map ()
+{
+	int fd, salt = daily_get_seed (0, TANGORINEBA_DAILY_SALT);
+	void *addr;
+	std::string dir, path;
+
+	if (cache || cache_unavailable)
+		return cache;
+
+	dir = std::string (g_get_user_cache_dir ()) + "/TangorineBA";
+	path = dir + "/daily.cache";
+	if (g_mkdir_with_parents (dir.c_str (), 0755) == -1 ||
+	    (fd = open (path.c_str (), O_RDWR | O_CREAT, 0644)) == -1) {
+		cache_unavailable = true;
+		return nullptr;
+	}
+
+	if (ftruncate (fd, sizeof (daily_cache_t)) == -1) {
+		close (fd);
+		cache_unavailable = true;
+		return nullptr;
+	}
+
+	addr = mmap (nullptr, sizeof (daily_cache_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close (fd);
+	if (addr == MAP_FAILED) {
+		cache_unavailable = true;
+		return nullptr;
+	}
+
+	cache = (daily_cache_t *) addr;
+	if (memcmp (cache->magic, daily_magic, sizeof (daily_magic)) ||
+	    cache->version != DAILY_CACHE_VERSION || cache->nslots != DAILY_CACHE_SLOTS ||
+	    cache->entry_size != (int) sizeof (daily_entry_t) || cache->salt != salt) {
+		memset (cache, 0, sizeof (daily_cache_t));
+		memcpy (cache->magic, daily_magic, sizeof (daily_magic));
+		cache->version = DAILY_CACHE_VERSION;
+		cache->nslots = DAILY_CACHE_SLOTS;
+		cache->entry_size = sizeof (daily_entry_t);
+		cache->salt = salt;
+	}
+
+	return cache;
+}
+
+const daily_entry_t *daily_cache_lookup (int date, int day)
+{
+	daily_cache_t *c = daily_cache_map ();
+
+	if (!c || c->slot[day % DAILY_CACHE_SLOTS].date != date)
+		return nullptr;
+
+	return &c->slot[day % DAILY_CACHE_SLOTS];
+}
+
+bool daily_cache_store (const daily_entry_t *entry)
+{
+	daily_cache_t *c = daily_cache_map ();
+
+	if (!c)
+		return false;
+
+	c->slot[entry->day % DAILY_CACHE_SLOTS] = *entry;
+	msync (c, sizeof (daily_cache_t), MS_ASYNC);
+	return true;
+}
+
+void daily_cache_evict (int today, int max_age)
+{
+	daily_cache_t *c = daily_cache_map ();
+
+	if (!c)
+		return;
+
+	for (int i = 0; i < DAILY_CACHE_SLOTS; i++)
+		if (c->slot[i].date && today - c->slot[i].day > max_age)
+			memset (&c->slot[i], 0, sizeof (daily_entry_t));
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _DAILY_H_
+#define _DAILY_H_	1
+#include <time.h>
+#include "common.h"
+#include "Puzzle.h"
+
+// Salt mixed with the calendar date, set with `./configure --with-daily-salt'
+#ifndef TANGORINEBA_DAILY_SALT
+#define TANGORINEBA_DAILY_SALT	"TangorineBA"
+#endif
+
+#define DAILY_ROLLOVER_HOUR	9	// A new board is published at 09:00 a.m.
+#define DAILY_CACHE_SLOTS	64	// One slot per day, direct-mapped
+#define DAILY_CACHE_MAX_AGE	30	// Days before an entry gets evicted
+
+// Everything we need to rebuild a daily board without calling prepare ()
+typedef struct daily_entry_st {
+	int date;		// YYYYMMDD, or 0 if the slot is free
+	int day;		// Days since the Epoch, used for eviction
+	puzzle_rec_t puzzle;
+} daily_entry_t;
+
+int daily_get_date (time_t now, int *day);
+int daily_get_seed (int date, const char *salt);
+const daily_entry_t *daily_cache_lookup (int date, int day);
+bool daily_cache_store (const daily_entry_t *entry);
+void daily_cache_evict (int today, int max_age);
+#endif
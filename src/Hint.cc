@@ -0,0 +1,311 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <gtk/gtk.h>
+#include "common.h"
+#include "Validate.h"
+#include "Solver.h"
+
+#define HINT_NUM_LINES		12
+#define HINT_NUM_RULES		3
+#define HINT_SEARCH_BUDGET	100000
+#define HINT_RULE(rule)		((rule) - HINT_CONSTRAINT)
+
+typedef enum {
+	HINT_NONE = 0,
+	HINT_PENDING,
+	HINT_CONSTRAINT,
+	HINT_THREE_ADJS,
+	HINT_BALANCE,
+	HINT_SEARCH,
+} hint_rule_t;
+
+typedef struct hint_st {
+	int ncell;
+	shape_t shape;
+	hint_rule_t rule;
+} hint_t;
+
+typedef struct hint_lines_st {
+	validate_cons_t cons;
+	uint8_t sun[HINT_NUM_RULES][HINT_NUM_LINES];
+	uint8_t moon[HINT_NUM_RULES][HINT_NUM_LINES];
+	uint16_t dirty;
+} hint_lines_t;
+
+// The board the worker has to search next, or key 0 if there's none
+typedef struct hint_job_st {
+	uint64_t key;
+	uint64_t filled;
+	uint64_t moons;
+	validate_cons_t cons;
+	GSourceFunc done;
+} hint_job_t;
+
+/*
+ * State shared with the worker. Like the worker itself, it is never freed:
+ * destroying a condition variable that a detached thread still waits on
+ * would hang the program on its way out
+ */
+typedef struct hint_worker_st {
+	std::mutex mutex;
+	std::condition_variable cond;
+	hint_job_t job;
+	uint64_t busy_key;		// Board being searched right now
+	uint64_t result_key;		// Board the result below belongs to
+	hint_t result;
+} hint_worker_t;
+
+static hint_worker_t *worker = nullptr;
+
+// Cell c of a line, rows going first and then columns
+static int hint_get_cell (int line, int c)
+{
+	return (line < 6) ? line * 6 + c : c * 6 + line - 6;
+}
+
+static uint8_t hint_get_line (uint64_t mask, int line)
+{
+	uint8_t x = 0;
+
+	if (line < 6)
+		return (mask >> (line * 6)) & 0x3f;
+
+	for (int r = 0; r < 6; r++)
+		x |= ((mask >> hint_get_cell (line, r)) & 1) << r;
+
+	return x;
+}
+
+/*
+ * Everything a single line tells about its empty cells: the shape on the
+ * other side of an '=' or 'x', the one breaking a pair or closing a gap
+ * between two equal shapes, and the one left once a shape reached 3
+ */
+static void hint_update_line (hint_lines_t *lines, int line, uint8_t f, uint8_t m, uint8_t eq, uint8_t df)
+{
+	uint8_t s = f & ~m, empty = ~f & 0x3f;
+	uint8_t pairs_s = s & (s >> 1), pairs_m = m & (m >> 1);
+	int r;
+
+	r = HINT_RULE (HINT_CONSTRAINT);
+	lines->sun[r][line] = empty & (((s & eq) << 1) | ((s >> 1) & eq) | ((m & df) << 1) | ((m >> 1) & df));
+	lines->moon[r][line] = empty & (((m & eq) << 1) | ((m >> 1) & eq) | ((s & df) << 1) | ((s >> 1) & df));
+
+	r = HINT_RULE (HINT_THREE_ADJS);
+	lines->sun[r][line] = empty & ((pairs_m << 2) | (pairs_m >> 1) | ((m & (m >> 2)) << 1));
+	lines->moon[r][line] = empty & ((pairs_s << 2) | (pairs_s >> 1) | ((s & (s >> 2)) << 1));
+
+	r = HINT_RULE (HINT_BALANCE);
+	lines->sun[r][line] = (__builtin_popcount (m) == 3) ? empty : 0;
+	lines->moon[r][line] = (__builtin_popcount (s) == 3) ? empty : 0;
+}
+
+/*
+ * Compute the dirty lines again, @cons being in the form of validate_get_cons ().
+ * Every line is dirty as well when the constraints aren't the same as last time
+ */
+void hint_update_lines (hint_lines_t *lines, uint64_t filled, uint64_t moons, const validate_cons_t *cons)
+{
+	int line;
+	uint8_t eq, df;
+
+	if (memcmp (&lines->cons, cons, sizeof (validate_cons_t))) {
+		lines->cons = *cons;
+		lines->dirty = (1 << HINT_NUM_LINES) - 1;
+	}
+
+	moons &= filled;
+	for (line = 0; line < HINT_NUM_LINES; line++) {
+		if (!(lines->dirty & (1 << line)))
+			continue;
+
+		eq = (cons->equal[line / 6] >> ((line % 6) * 8)) & 0x1f;
+		df = (cons->diff[line / 6] >> ((line % 6) * 8)) & 0x1f;
+		hint_update_line (lines, line, hint_get_line (filled, line), hint_get_line (moons, line), eq, df);
+	}
+	lines->dirty = 0;
+}
+
+/*
+ * The first cell forced by the simplest rule. A cell forced to both shapes
+ * means that the guess is already wrong, and then no hint is given at all
+ */
+bool hint_pick (const hint_lines_t *lines, hint_t *hint)
+{
+	int r, line, c;
+	uint64_t sun[HINT_NUM_RULES] = { }, moon[HINT_NUM_RULES] = { };
+	uint64_t all_suns = 0, all_moons = 0, cand;
+
+	for (r = 0; r < HINT_NUM_RULES; r++) {
+		for (line = 0; line < HINT_NUM_LINES; line++) {
+			for (c = 0; c < 6; c++) {
+				if ((lines->sun[r][line] >> c) & 1)
+					sun[r] |= CELL_BIT (hint_get_cell (line, c));
+				if ((lines->moon[r][line] >> c) & 1)
+					moon[r] |= CELL_BIT (hint_get_cell (line, c));
+			}
+		}
+		all_suns |= sun[r];
+		all_moons |= moon[r];
+	}
+
+	if (all_suns & all_moons)
+		return false;
+
+	for (r = 0; r < HINT_NUM_RULES; r++) {
+		if (!(cand = sun[r] | moon[r]))
+			continue;
+
+		hint->ncell = __builtin_ctzll (cand);
+		hint->shape = (moon[r] & CELL_BIT (hint->ncell)) ? SHAPE_MOON : SHAPE_SUN;
+		hint->rule = (hint_rule_t) (HINT_CONSTRAINT + r);
+		return true;
+	}
+
+	return false;
+}
+
+const char *hint_describe (hint_rule_t rule)
+{
+	switch (rule) {
+	case HINT_CONSTRAINT:
+		return "The '=' or 'x' sign next to this cell tells its shape";
+	case HINT_THREE_ADJS:
+		return "The other shape would make three of a kind in a row";
+	case HINT_BALANCE:
+		return "This line already holds three of the other shape";
+	case HINT_SEARCH:
+		return "Every way to complete the board agrees on this cell";
+	case HINT_PENDING:
+		return "Still looking for a hint...";
+	default:
+		return "No cell can be worked out from here";
+	}
+}
+
+/*
+ * Intersect every valid grid that agrees with the guess and honors @cons,
+ * and give the first empty cell where all of them agree. Returns false if
+ * the monotonic clock went past @deadline before the end of the table
+ */
+bool hint_search (uint64_t filled, uint64_t moons, const validate_cons_t *cons, int64_t deadline, hint_t *hint)
+{
+	const uint64_t *grids, all = ((uint64_t) 1 << 36) - 1;
+	size_t i, count = solver_get_grids (&grids);
+	uint64_t agree_moons = all, agree_suns = all, forced;
+	bool found = false;
+
+	hint->ncell = -1;
+	hint->shape = SHAPE_EMPTY;
+	hint->rule = HINT_NONE;
+	moons &= filled;
+	for (i = 0; i < count; i++) {
+		if (!(i & 1023) && g_get_monotonic_time () > deadline)
+			return false;
+		if (((grids[i] & filled) ^ moons) || validate_board (all, grids[i], cons))
+			continue;
+
+		agree_moons &= grids[i];
+		agree_suns &= ~grids[i];
+		found = true;
+	}
+
+	if (found && (forced = (agree_moons | agree_suns) & ~filled & all)) {
+		hint->ncell = __builtin_ctzll (forced);
+		hint->shape = (agree_moons & CELL_BIT (hint->ncell)) ? SHAPE_MOON : SHAPE_SUN;
+		hint->rule = HINT_SEARCH;
+	}
+
+	return true;
+}
+
+/*
+ * A single worker, started on the first search and kept waiting for the
+ * next one. Only the latest board is worth searching, so a new job just
+ * replaces the one waiting, if any. A search that runs out of time is
+ * answered with HINT_NONE, so it isn't tried again for the same board
+ */
+static void hint_worker (hint_worker_t *w)
+{
+	hint_job_t job;
+	hint_t hint;
+	std::unique_lock<std::mutex> lock (w->mutex);
+
+	while (true) {
+		while (!w->job.key)
+			w->cond.wait (lock);
+		job = w->job;
+		w->job.key = 0;
+		w->busy_key = job.key;
+		lock.unlock ();
+
+		if (!hint_search (job.filled, job.moons, &job.cons, g_get_monotonic_time () + HINT_SEARCH_BUDGET, &hint))
+			hint.rule = HINT_NONE;
+
+		lock.lock ();
+		w->busy_key = 0;
+		w->result_key = job.key;
+		w->result = hint;
+		if (job.done)
+			g_idle_add (job.done, nullptr);
+	}
+}
+
+/*
+ * Search the board known as @key (which must not be 0) in the background,
+ * and call @done from the main loop once the result is ready
+ */
+void hint_search_start (uint64_t key, uint64_t filled, uint64_t moons, const validate_cons_t *cons, GSourceFunc done)
+{
+	if (!worker) {
+		worker = new hint_worker_t ();
+		std::thread (hint_worker, worker).detach ();
+	}
+
+	std::lock_guard<std::mutex> lock (worker->mutex);
+
+	if (key == worker->result_key || key == worker->busy_key || key == worker->job.key)
+		return;
+
+	worker->job.key = key;
+	worker->job.filled = filled;
+	worker->job.moons = moons;
+	worker->job.cons = *cons;
+	worker->job.done = done;
+	worker->cond.notify_one ();
+}
+
+bool hint_search_result (uint64_t key, hint_t *hint)
+{
+	if (!worker)
+		return false;
+
+	std::lock_guard<std::mutex> lock (worker->mutex);
+
+	if (key != worker->result_key)
+		return false;
+
+	*hint = worker->result;
+	return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _HINT_H_
+#define _HINT_H_	1
+#include <stdint.h>
+#include <gtk/gtk.h>
+#include "common.h"
+#include "Validate.h"
+
+#define HINT_NUM_LINES		12	// Rows 0-5, then columns 0-5
+#define HINT_NUM_RULES		3	// Rules checked line by line, see hint_rule_t
+#define HINT_SEARCH_BUDGET	100000	// Microseconds before the search gives up
+#define HINT_RULE(rule)		((rule) - HINT_CONSTRAINT)	// Index of a rule in hint_lines_t
+
+typedef enum {
+	HINT_NONE = 0,		// Nothing can be forced, or the board is already wrong
+	HINT_PENDING,		// Only the search could tell, and it's still running
+	HINT_CONSTRAINT,	// An '=' or 'x' next to a filled cell
+	HINT_THREE_ADJS,	// The other shape would make three in a row
+	HINT_BALANCE,		// The line already holds three of the other shape
+	HINT_SEARCH,		// Every way to complete the board agrees on it
+} hint_rule_t;
+
+typedef struct hint_st {
+	int ncell;
+	shape_t shape;
+	hint_rule_t rule;
+} hint_t;
+
+/*
+ * Cells forced by each rule, 6 bits per line, kept across moves: a move
+ * only marks its row and column as dirty, and those are the only lines
+ * computed again when the next hint is asked for
+ */
+typedef struct hint_lines_st {
+	validate_cons_t cons;		// Constraints the lines were computed with
+	uint8_t sun[HINT_NUM_RULES][HINT_NUM_LINES];
+	uint8_t moon[HINT_NUM_RULES][HINT_NUM_LINES];
+	uint16_t dirty;			// Bit n: line n has to be computed again
+} hint_lines_t;
+
+void hint_update_lines (hint_lines_t *lines, uint64_t filled, uint64_t moons, const validate_cons_t *cons);
+bool hint_pick (const hint_lines_t *lines, hint_t *hint);
+const char *hint_describe (hint_rule_t rule);
+
+bool hint_search (uint64_t filled, uint64_t moons, const validate_cons_t *cons, int64_t deadline, hint_t *hint);
+void hint_search_start (uint64_t key, uint64_t filled, uint64_t moons, const validate_cons_t *cons, GSourceFunc done);
+bool hint_search_result (uint64_t key, hint_t *hint);
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <stdint.h>
+#include <gtk/gtk.h>
+
+#define HUD_NUM_FRAMES		1024
+#define HUD_PENDING_FRAMES	16
+#define HUD_FPS_FRAMES		60
+#define HUD_WIDTH		240
+#define HUD_HEIGHT		40
+
+typedef struct hud_frame_st {
+	int64_t counter;
+	int64_t frame_time;
+	int64_t presentation_time;
+	int64_t draw_time;
+	int64_t end_time;
+	int64_t latency;
+	int dirty;
+	uint32_t click_time;
+} hud_frame_t;
+
+typedef struct hud_st {
+	hud_frame_t frame[HUD_NUM_FRAMES];
+	int64_t nframes;
+	int64_t draw_start;
+	uint32_t click_time;
+	int64_t last_latency;
+	int64_t tick_time[HUD_FPS_FRAMES];
+	int64_t nticks;
+} hud_t;
+
+hud_t *hud_new ()
+{
+	hud_t *hud = new hud_t ();
+
+	hud->last_latency = -1;
+	return hud;
+}
+
+// Only the first click of a frame is timed, later ones show up in the same frame
+void hud_click (hud_t *hud, uint32_t time)
+{
+	if (!hud->click_time)
+		hud->click_time = time + !time;
+}
+
+/*
+ * GDK only keeps the timings of the last few frames, so the frames still
+ * waiting for their presentation time are looked up on every new frame.
+ * Backends which never report it leave the end of draw_cb () instead.
+ * Returns whether the latency of some click got known
+ */
+static bool hud_update_presented (hud_t *hud, GdkFrameClock *clock)
+{
+	int64_t n = hud->nframes > HUD_PENDING_FRAMES ? hud->nframes - HUD_PENDING_FRAMES : 0;
+	GdkFrameTimings *timings;
+	bool latency = false;
+
+	for (; n < hud->nframes; n++) {
+		hud_frame_t& f = hud->frame[n & (HUD_NUM_FRAMES - 1)];
+
+		if (f.presentation_time)
+			continue;
+		if (!clock || !(timings = gdk_frame_clock_get_timings (clock, f.counter))) {
+			f.presentation_time = -1;
+		} else if (gdk_frame_timings_get_complete (timings)) {
+			f.presentation_time = gdk_frame_timings_get_presentation_time (timings);
+			if (!f.presentation_time)
+				f.presentation_time = -1;
+		} else {
+			continue;
+		}
+
+		if (f.click_time) {
+			int64_t shown = (f.presentation_time > 0) ? f.presentation_time : f.end_time;
+
+			f.latency = (int64_t) (uint32_t) (shown / 1000 - f.click_time) * 1000;
+			hud->last_latency = f.latency;
+			latency = true;
+		}
+	}
+
+	return latency;
+}
+
+void hud_begin_frame (hud_t *hud, GdkFrameClock *clock, cairo_t *cr)
+{
+	hud_frame_t& f = hud->frame[hud->nframes & (HUD_NUM_FRAMES - 1)];
+	double x0, y0, x1, y1;
+
+	hud_update_presented (hud, clock);
+	hud->draw_start = g_get_monotonic_time ();
+
+	cairo_clip_extents (cr, &x0, &y0, &x1, &y1);
+	f.counter = clock ? gdk_frame_clock_get_frame_counter (clock) : hud->nframes;
+	f.frame_time = clock ? gdk_frame_clock_get_frame_time (clock) : hud->draw_start;
+	f.presentation_time = 0;
+	f.draw_time = 0;
+	f.end_time = 0;
+	f.latency = -1;
+	f.dirty = (int) ((x1 - x0) * (y1 - y0));
+	f.click_time = hud->click_time;
+	hud->click_time = 0;
+}
+
+void hud_end_frame (hud_t *hud)
+{
+	hud_frame_t& f = hud->frame[hud->nframes & (HUD_NUM_FRAMES - 1)];
+
+	f.end_time = g_get_monotonic_time ();
+	f.draw_time = f.end_time - hud->draw_start;
+	hud->nframes++;
+}
+
+/*
+ * Called on every tick of the frame clock, which only gathers its timings:
+ * the board is not drawn again for that. Returns whether the figures shown
+ * changed enough for the HUD to be drawn again, that is, when a latency got
+ * known and once every HUD_FPS_FRAMES ticks for the frame rate
+ */
+bool hud_tick (hud_t *hud, GdkFrameClock *clock)
+{
+	bool latency = hud_update_presented (hud, clock);
+
+	hud->tick_time[hud->nticks % HUD_FPS_FRAMES] = gdk_frame_clock_get_frame_time (clock);
+	hud->nticks++;
+
+	return latency || !(hud->nticks % HUD_FPS_FRAMES);
+}
+
+// Whether only the box of the HUD is being drawn again
+bool hud_clip_is_inside (cairo_t *cr)
+{
+	double x0, y0, x1, y1;
+
+	cairo_clip_extents (cr, &x0, &y0, &x1, &y1);
+	return x0 >= 0 && y0 >= 0 && x1 <= HUD_WIDTH && y1 <= HUD_HEIGHT;
+}
+
+// Frames per second over the last HUD_FPS_FRAMES ticks of the frame clock
+static double hud_get_fps (const hud_t *hud)
+{
+	int64_t n = hud->nticks < HUD_FPS_FRAMES ? hud->nticks : HUD_FPS_FRAMES;
+	int64_t first, last;
+
+	if (n < 2)
+		return 0.0;
+
+	first = hud->tick_time[(hud->nticks - n) % HUD_FPS_FRAMES];
+	last = hud->tick_time[(hud->nticks - 1) % HUD_FPS_FRAMES];
+	if (last <= first)
+		return 0.0;
+
+	return (n - 1) * 1e6 / (last - first);
+}
+
+/*
+ * Figures of the last frame, in the top left corner of the board. The box
+ * is opaque, so that it can be drawn again on its own over the previous one
+ */
+void hud_draw (const hud_t *hud, cairo_t *cr)
+{
+	char text[2][64];
+	const hud_frame_t *f;
+
+	if (!hud->nframes)
+		return;
+
+	f = &hud->frame[(hud->nframes - 1) & (HUD_NUM_FRAMES - 1)];
+	if (hud->last_latency < 0)
+		snprintf (text[0], sizeof (text[0]), "latency -- ms  fps %.1f", hud_get_fps (hud));
+	else
+		snprintf (text[0], sizeof (text[0]), "latency %.1f ms  fps %.1f", hud->last_latency / 1000.0, hud_get_fps (hud));
+	snprintf (text[1], sizeof (text[1]), "draw %.2f ms  dirty %d px", f->draw_time / 1000.0, f->dirty);
+
+	cairo_save (cr);
+	cairo_set_source_rgba (cr, 0.0, 0.0, 0.0, 1.0);
+	cairo_rectangle (cr, 0, 0, HUD_WIDTH, HUD_HEIGHT);
+	cairo_fill (cr);
+	cairo_select_font_face (cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+	cairo_set_font_size (cr, 12);
+	cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+	for (int i = 0; i < 2; i++) {
+		cairo_move_to (cr, 6, 16 + i * 16);
+		cairo_show_text (cr, text[i]);
+	}
+	cairo_restore (cr);
+}
+
+// The frames still in the ring as CSV, oldest first
+bool hud_dump (const hud_t *hud, const char *path)
+{
+	FILE *fp;
+	int64_t n = hud->nframes > HUD_NUM_FRAMES ? hud->nframes - HUD_NUM_FRAMES : 0;
+
+	if (!(fp = fopen (path, "w")))
+		return false;
+
+	fprintf (fp, "frame,frame_time_us,presentation_time_us,draw_us,dirty_px,click_time_ms,latency_us\n");
+	for (; n < hud->nframes; n++) {
+		const hud_frame_t& f = hud->frame[n & (HUD_NUM_FRAMES - 1)];
+
+		fprintf (fp, "%lld,%lld,%lld,%lld,%d,%u,%lld\n", (long long) f.counter, (long long) f.frame_time,
+			 (long long) f.presentation_time, (long long) f.draw_time, f.dirty, f.click_time,
+			 (long long) f.latency);
+	}
+
+	return !fclose (fp);
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _HUD_H_
+#define _HUD_H_	1
+#include <stdint.h>
+#include <gtk/gtk.h>
+
+#define HUD_NUM_FRAMES		1024	// Frames kept for hud_dump (), a power of 2
+#define HUD_PENDING_FRAMES	16	// Frames waiting for the frame clock to tell their presentation time
+#define HUD_FPS_FRAMES		60	// Frames the frame rate is averaged over
+#define HUD_WIDTH		240	// Box of the HUD, in the top left corner of the board
+#define HUD_HEIGHT		40
+
+typedef struct hud_frame_st {
+	int64_t counter;		// Frame counter of the frame clock
+	int64_t frame_time;		// Microseconds, as given by the frame clock
+	int64_t presentation_time;	// Microseconds, 0 while unknown and -1 if never reported
+	int64_t draw_time;		// Microseconds spent in draw_cb ()
+	int64_t end_time;		// Monotonic time at the end of draw_cb ()
+	int64_t latency;		// Microseconds from the click to the presentation, or -1
+	int dirty;			// Pixels drawn again
+	uint32_t click_time;		// GdkEventButton time of the click, 0 for none
+} hud_frame_t;
+
+/*
+ * Telemetry of the last HUD_NUM_FRAMES frames of the board. Clicks are
+ * matched to the first frame drawn after them, and their latency is known
+ * once the frame clock reports that frame as presented. Event times are
+ * milliseconds of the monotonic clock, as with Wayland and Xorg on Linux.
+ * The frame rate comes from the ticks of the frame clock instead, since the
+ * board is only drawn again when something changes
+ */
+typedef struct hud_st {
+	hud_frame_t frame[HUD_NUM_FRAMES];
+	int64_t nframes;		// Frames recorded so far
+	int64_t draw_start;
+	uint32_t click_time;		// Click waiting for the next frame
+	int64_t last_latency;		// Latency of the last click presented, or -1
+	int64_t tick_time[HUD_FPS_FRAMES];	// Frame times of the last ticks
+	int64_t nticks;
+} hud_t;
+
+hud_t *hud_new ();
+void hud_click (hud_t *hud, uint32_t time);
+void hud_begin_frame (hud_t *hud, GdkFrameClock *clock, cairo_t *cr);
+void hud_end_frame (hud_t *hud);
+bool hud_tick (hud_t *hud, GdkFrameClock *clock);
+bool hud_clip_is_inside (cairo_t *cr);
+void hud_draw (const hud_t *hud, cairo_t *cr);
+bool hud_dump (const hud_t *hud, const char *path);
+#endif
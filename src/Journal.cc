@@ -0,0 +1,318 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <gtk/gtk.h>
+#include "common.h"
+#include "Puzzle.h"
+#include "Daily.h"
+
+typedef enum {
+	JOURNAL_MOVE = 0,
+	JOURNAL_UNDO,
+	JOURNAL_REDO,
+	JOURNAL_CLEAR,
+	JOURNAL_END,
+	JOURNAL_SNAPSHOT
+} journal_type_t;
+
+typedef struct journal_header_st {
+	char magic[8];
+	uint32_t version;
+	uint32_t interval;
+	puzzle_rec_t puzzle;
+	int64_t start_time;
+	uint64_t reserved[2];
+} journal_header_t;
+
+typedef struct journal_rec_st {
+	uint8_t type;
+	uint8_t ncell;
+	uint8_t shape;
+	uint8_t reserved;
+	uint32_t nmove;
+	union {
+		int64_t time;
+		uint64_t snapshot;
+	};
+} journal_rec_t;
+
+typedef struct journal_writer_st {
+	FILE *fp;
+	uint32_t interval;
+	uint32_t nmoves;
+	uint64_t imm;
+} journal_writer_t;
+
+typedef struct journal_st {
+	void *map;
+	size_t size;
+	const journal_header_t *hdr;
+	const journal_rec_t *rec;
+	uint64_t nrecs;
+	uint32_t nmoves;
+} journal_t;
+
+static_assert (sizeof (journal_header_t) == 64, "journal_header_t must be 64 bytes long");
+static_assert (sizeof (journal_rec_t) == 16, "journal_rec_t must be 16 bytes long");
+
+static const char journal_magic[8] = { 'T', 'G', 'B', 'A', 'J', 'R', 'N', 'L' };
+
+/*
+ * Immutable cells never change and are known from the puzzle, so a
+ * snapshot only stores the 30 mutable cells, 2 bits each (0 = empty,
+ * 1 = sun, 2 = moon), in ascending order. That fits in 64 bits
+ */
+uint64_t journal_pack (uint64_t imm, uint64_t filled, uint64_t moons)
+{
+	int n, shift = 0;
+	uint64_t m, snapshot = 0;
+
+	for (m = ~imm & (((uint64_t) 1 << 36) - 1); m; shift += 2) {
+		n = pop_cell (&m);
+		if (filled & CELL_BIT (n))
+			snapshot |= (uint64_t) ((moons & CELL_BIT (n)) ? 2 : 1) << shift;
+	}
+
+	return snapshot;
+}
+
+void journal_unpack (uint64_t imm, uint64_t snapshot, uint64_t *filled, uint64_t *moons)
+{
+	int n, shift = 0;
+	uint64_t m;
+
+	*filled = 0;
+	*moons = 0;
+	for (m = ~imm & (((uint64_t) 1 << 36) - 1); m; shift += 2) {
+		n = pop_cell (&m);
+		switch ((snapshot >> shift) & 3) {
+		case 2:
+			*moons |= CELL_BIT (n);
+			/* fall through */
+		case 1:
+			*filled |= CELL_BIT (n);
+			break;
+		}
+	}
+}
+
+/*
+ * Journals are named after the time they were created at, so the ones older
+ * than @max_age days get removed, the same way daily_cache_evict () frees
+ * its slots. Anything else found in @dir is left alone
+ */
+static void journal_evict (const std::string& dir, int today, int max_age)
+{
+	GDir *d;
+	const char *name;
+	long long created;
+	size_t len;
+
+	if (!(d = g_dir_open (dir.c_str (), 0, nullptr)))
+		return;
+
+	while ((name = g_dir_read_name (d))) {
+		len = strlen (name);
+		if (sscanf (name, "%lld-", &created) != 1 || len < 8 || strcmp (name + len - 8, ".journal"))
+			continue;
+		if (today - created / 86400 > max_age)
+			unlink ((dir + "/" + name).c_str ());
+	}
+	g_dir_close (d);
+}
+
+/*
+ * One journal per game under $XDG_DATA_HOME/TangorineBA/journal, kept for
+ * DAILY_CACHE_MAX_AGE days. Two games may start on the same board within
+ * the same second, so @n, the number of names already found taken, makes
+ * the name unique: journal_writer_create () never overwrites a journal
+ */
+std::string journal_default_path (int seed, int n)
+{
+	std::string dir = std::string (g_get_user_data_dir ()) + "/TangorineBA/journal";
+	std::string name;
+	time_t now = time (nullptr);
+
+	if (g_mkdir_with_parents (dir.c_str (), 0755) == -1)
+		return "";
+	if (!n)
+		journal_evict (dir, now / 86400, DAILY_CACHE_MAX_AGE);
+
+	name = std::to_string ((long long) now) + "-" + std::to_string (seed);
+	if (n)
+		name += "-" + std::to_string (n);
+
+	return dir + "/" + name + ".journal";
+}
+
+// Fails with errno set to EEXIST when @path is already there
+journal_writer_t *journal_writer_create (const char *path, const puzzle_rec_t *puzzle, uint32_t interval)
+{
+	int fd;
+	FILE *fp;
+	journal_header_t hdr;
+	journal_writer_t *w;
+
+	if (!interval || (fd = open (path, O_WRONLY | O_CREAT | O_EXCL, 0644)) == -1)
+		return nullptr;
+	if (!(fp = fdopen (fd, "wb"))) {
+		close (fd);
+		return nullptr;
+	}
+
+	memset (&hdr, 0, sizeof (hdr));
+	memcpy (hdr.magic, journal_magic, sizeof (journal_magic));
+	hdr.version = 1;
+	hdr.interval = interval;
+	hdr.puzzle = *puzzle;
+	hdr.start_time = time (nullptr);
+	if (fwrite (&hdr, sizeof (hdr), 1, fp) != 1 || fflush (fp)) {
+		fclose (fp);
+		return nullptr;
+	}
+
+	w = new journal_writer_t;
+	w->fp = fp;
+	w->interval = interval;
+	w->nmoves = 0;
+	w->imm = puzzle->immutable;
+
+	return w;
+}
+
+/*
+ * Append one move, @filled and @moons being the user's guess right after
+ * it. Records are flushed at once, so a crash loses nothing but the move
+ * being written
+ */
+bool journal_writer_append (journal_writer_t *w, journal_type_t type, int ncell, shape_t shape,
+			    int64_t time, uint64_t filled, uint64_t moons)
+{
+	journal_rec_t rec[2];
+	size_t n = 1;
+
+	memset (rec, 0, sizeof (rec));
+	rec[0].type = type;
+	rec[0].ncell = ncell;
+	rec[0].shape = shape;
+	rec[0].nmove = ++w->nmoves;
+	rec[0].time = time;
+
+	if (!(w->nmoves % w->interval)) {
+		rec[1].type = JOURNAL_SNAPSHOT;
+		rec[1].nmove = w->nmoves;
+		rec[1].snapshot = journal_pack (w->imm, filled, moons);
+		n++;
+	}
+
+	return fwrite (rec, sizeof (journal_rec_t), n, w->fp) == n && !fflush (w->fp);
+}
+
+void journal_writer_close (journal_writer_t *w)
+{
+	if (!w)
+		return;
+
+	fclose (w->fp);
+	delete w;
+}
+
+journal_t *journal_open (const char *path)
+{
+	int fd;
+	void *addr;
+	struct stat st;
+	const journal_header_t *hdr;
+	journal_t *j;
+	uint64_t nrecs;
+
+	if ((fd = open (path, O_RDONLY)) == -1)
+		return nullptr;
+
+	if (fstat (fd, &st) == -1 || (size_t) st.st_size < sizeof (journal_header_t)) {
+		close (fd);
+		return nullptr;
+	}
+
+	addr = mmap (nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (addr == MAP_FAILED)
+		return nullptr;
+
+	hdr = (const journal_header_t *) addr;
+	if (memcmp (hdr->magic, journal_magic, sizeof (journal_magic)) || hdr->version != 1 || !hdr->interval) {
+		munmap (addr, st.st_size);
+		return nullptr;
+	}
+
+	// A trailing partial record means the game crashed in the middle of a write
+	nrecs = (st.st_size - sizeof (journal_header_t)) / sizeof (journal_rec_t);
+
+	j = new journal_t;
+	j->map = addr;
+	j->size = st.st_size;
+	j->hdr = hdr;
+	j->rec = (const journal_rec_t *) ((const char *) addr + sizeof (journal_header_t));
+	j->nrecs = nrecs;
+	j->nmoves = nrecs - nrecs / (hdr->interval + 1);
+
+	return j;
+}
+
+void journal_close (journal_t *j)
+{
+	if (!j)
+		return;
+
+	munmap (j->map, j->size);
+	delete j;
+}
+
+// Move #n, counting from 0
+const journal_rec_t *journal_get_move (const journal_t *j, uint32_t n)
+{
+	if (n >= j->nmoves)
+		return nullptr;
+
+	return &j->rec[n + n / j->hdr->interval];
+}
+
+// Latest snapshot taken after at most @n moves, or nullptr if there's none
+const journal_rec_t *journal_get_snapshot (const journal_t *j, uint32_t n)
+{
+	uint64_t k = n / j->hdr->interval;
+
+	if (!k)
+		return nullptr;
+
+	if (k * (j->hdr->interval + 1) - 1 >= j->nrecs)
+		k = j->nrecs / (j->hdr->interval + 1);
+	if (!k)
+		return nullptr;
+
+	return &j->rec[k * (j->hdr->interval + 1) - 1];
+}
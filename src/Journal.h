@@ -0,0 +1,97 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _JOURNAL_H_
+#define _JOURNAL_H_	1
+#include <cstdio>
+#include <string>
+#include <stdint.h>
+#include "common.h"
+#include "Puzzle.h"
+
+#define JOURNAL_SNAPSHOT_INTERVAL	32	// Moves between two snapshots
+#define JOURNAL_NAME_TRIES		100	// Names tried for a new journal before giving up
+
+typedef enum {
+	JOURNAL_MOVE = 0,	// The player clicked on a cell
+	JOURNAL_UNDO,
+	JOURNAL_REDO,
+	JOURNAL_CLEAR,		// Every mutable cell got emptied
+	JOURNAL_END,		// The board got solved
+	JOURNAL_SNAPSHOT
+} journal_type_t;
+
+/*
+ * A journal is a header followed by fixed-size records, and it is only
+ * ever appended to. After every JOURNAL_SNAPSHOT_INTERVAL moves there is
+ * a snapshot of the user's guess, so move #n lives at record
+ * n + n / interval and replaying up to any move never takes more than
+ * interval moves (see Board::replay_journal ())
+ */
+typedef struct journal_header_st {
+	char magic[8];
+	uint32_t version;
+	uint32_t interval;
+	puzzle_rec_t puzzle;
+	int64_t start_time;	// Seconds since the Epoch
+	uint64_t reserved[2];
+} journal_header_t;
+
+typedef struct journal_rec_st {
+	uint8_t type;
+	uint8_t ncell;
+	uint8_t shape;
+	uint8_t reserved;
+	uint32_t nmove;		// Moves recorded so far, including this one
+	union {
+		int64_t time;		// Microseconds since the game started
+		uint64_t snapshot;	// 2 bits per mutable cell, see journal_pack ()
+	};
+} journal_rec_t;
+
+typedef struct journal_writer_st {
+	FILE *fp;
+	uint32_t interval;
+	uint32_t nmoves;
+	uint64_t imm;
+} journal_writer_t;
+
+typedef struct journal_st {
+	void *map;
+	size_t size;
+	const journal_header_t *hdr;
+	const journal_rec_t *rec;
+	uint64_t nrecs;
+	uint32_t nmoves;
+} journal_t;
+
+uint64_t journal_pack (uint64_t imm, uint64_t filled, uint64_t moons);
+void journal_unpack (uint64_t imm, uint64_t snapshot, uint64_t *filled, uint64_t *moons);
+std::string journal_default_path (int seed, int n);
+
+journal_writer_t *journal_writer_create (const char *path, const puzzle_rec_t *puzzle, uint32_t interval);
+bool journal_writer_append (journal_writer_t *w, journal_type_t type, int ncell, shape_t shape,
+			    int64_t time, uint64_t filled, uint64_t moons);
+void journal_writer_close (journal_writer_t *w);
+
+journal_t *journal_open (const char *path);
+void journal_close (journal_t *j);
+const journal_rec_t *journal_get_move (const journal_t *j, uint32_t n);
+const journal_rec_t *journal_get_snapshot (const journal_t *j, uint32_t n);
+#endif
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define LOG_RING_SLOTS		512
+#define LOG_LINE_MAX		256
+
+typedef enum {
+	LOG_LEVEL_OFF = -1,
+	LOG_LEVEL_ERROR = 0,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_DEBUG,
+} log_level_t;
+
+/*
+ * A slot is free for the writer that reserved position n when its sequence
+ * is n, and holds a line ready for the drainer once it is n + 1. Once the
+ * line is written out, the drainer hands the slot to the writer of the next
+ * round by setting it to n + LOG_RING_SLOTS.
+ *
+ * The drainer sleeps on @wake while the ring is empty. Writers only take
+ * @lock to signal it when it said so through @sleeping, and the drainer
+ * signals @drained under the same lock after every pass, for log_flush ()
+ */
+typedef struct log_slot_st {
+	std::atomic<size_t> seq;
+	log_level_t level;
+	char text[LOG_LINE_MAX];
+} log_slot_t;
+
+typedef struct log_ring_st {
+	log_slot_t slot[LOG_RING_SLOTS];
+	std::atomic<size_t> tail;	// Next position to be reserved by a writer
+	std::atomic<size_t> head;	// Next position to be written out
+	std::atomic<size_t> dropped;	// Lines lost while the ring was full
+	std::atomic<bool> sleeping;	// The drainer is waiting, or about to
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable drained;
+} log_ring_t;
+
+static const char *log_tags[] = { "error: ", "warning: ", "", "debug: " };
+static const char *log_names[] = { "error", "warning", "info", "debug" };
+static std::atomic<int> log_level (LOG_LEVEL_DEBUG + 1);	// Not read from the environment yet
+static log_ring_t *ring = nullptr;
+static std::once_flag ring_once;
+
+static void log_drain (log_ring_t *r);
+void log_flush ();
+
+// $TANGORINEBA_LOG is one of "off", "error", "warning", "info" or "debug"
+static int log_get_level ()
+{
+	const char *env = getenv ("TANGORINEBA_LOG");
+	int level;
+
+	if (!env)
+		return LOG_LEVEL_INFO;
+	for (level = LOG_LEVEL_ERROR; level <= LOG_LEVEL_DEBUG; level++)
+		if (!strcmp (env, log_names[level]))
+			return level;
+
+	return LOG_LEVEL_OFF;
+}
+
+static void log_start ()
+{
+	ring = new log_ring_t ();
+	for (size_t i = 0; i < LOG_RING_SLOTS; i++)
+		ring->slot[i].seq.store (i, std::memory_order_relaxed);
+	std::thread (log_drain, ring).detach ();
+	atexit (log_flush);
+}
+
+bool log_enabled (log_level_t level)
+{
+	int l = log_level.load (std::memory_order_relaxed);
+
+	if (l > LOG_LEVEL_DEBUG) {
+		l = log_get_level ();
+		log_level.store (l, std::memory_order_relaxed);
+	}
+
+	return level <= l;
+}
+
+// Override $TANGORINEBA_LOG, giving back the level in force so far
+log_level_t log_set_level (log_level_t level)
+{
+	int l = log_level.exchange (level, std::memory_order_relaxed);
+
+	return (log_level_t) (l > LOG_LEVEL_DEBUG ? log_get_level () : l);
+}
+
+// Write out every line ready so far, in the order they were reserved
+static bool log_drain_ready (log_ring_t *r)
+{
+	size_t pos = r->head.load (std::memory_order_relaxed), n;
+	log_slot_t *s;
+	bool any = false;
+
+	while (true) {
+		s = &r->slot[pos & (LOG_RING_SLOTS - 1)];
+		if (s->seq.load (std::memory_order_acquire) != pos + 1)
+			break;
+
+		fputs (log_tags[s->level], stdout);
+		fputs (s->text, stdout);
+		fputc ('\n', stdout);
+		s->seq.store (pos + LOG_RING_SLOTS, std::memory_order_release);
+		r->head.store (++pos, std::memory_order_release);
+		any = true;
+	}
+
+	if ((n = r->dropped.exchange (0, std::memory_order_relaxed)))
+		fprintf (stdout, "%s%zu lines were dropped\n", log_tags[LOG_LEVEL_WARNING], n);
+	if (any || n)
+		fflush (stdout);
+
+	return any;
+}
+
+// Whether the next line is ready, or some were dropped
+static bool log_pending (log_ring_t *r)
+{
+	size_t pos = r->head.load (std::memory_order_relaxed);
+
+	return r->slot[pos & (LOG_RING_SLOTS - 1)].seq.load (std::memory_order_acquire) == pos + 1 ||
+	       r->dropped.load (std::memory_order_relaxed);
+}
+
+/*
+ * Both the drainer and the writers exchange @sleeping, so that either the
+ * writer finds the drainer asleep and signals it, or the drainer sees the
+ * line the writer published before
+ */
+static void log_drain (log_ring_t *r)
+{
+	std::unique_lock<std::mutex> lock (r->lock);
+
+	while (true) {
+		lock.unlock ();
+		log_drain_ready (r);
+		lock.lock ();
+		r->drained.notify_all ();
+
+		r->sleeping.exchange (true, std::memory_order_acq_rel);
+		if (!log_pending (r))
+			r->wake.wait (lock);
+		r->sleeping.store (false, std::memory_order_relaxed);
+	}
+}
+
+static void log_wake (log_ring_t *r)
+{
+	if (!r->sleeping.exchange (false, std::memory_order_acq_rel))
+		return;
+
+	std::lock_guard<std::mutex> lock (r->lock);
+	r->wake.notify_one ();
+}
+
+/*
+ * Reserve a slot, format the line right into it and publish it. This never
+ * waits for the drainer: when the ring is full, the line is dropped and only
+ * counted, so neither the generator nor the main loop ever stall on stdout.
+ * The lock is only taken when the drainer is asleep, to wake it up
+ */
+void log_printf (log_level_t level, const char *fmt, ...)
+{
+	size_t pos;
+	log_slot_t *s;
+	va_list ap;
+
+	std::call_once (ring_once, log_start);
+
+	pos = ring->tail.load (std::memory_order_relaxed);
+	while (true) {
+		s = &ring->slot[pos & (LOG_RING_SLOTS - 1)];
+		if (s->seq.load (std::memory_order_acquire) != pos) {
+			if (s->seq.load (std::memory_order_acquire) < pos) {
+				ring->dropped.fetch_add (1, std::memory_order_relaxed);
+				log_wake (ring);
+				return;
+			}
+			pos = ring->tail.load (std::memory_order_relaxed);
+		} else if (ring->tail.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) {
+			break;
+		}
+	}
+
+	va_start (ap, fmt);
+	vsnprintf (s->text, LOG_LINE_MAX, fmt, ap);
+	va_end (ap);
+	s->level = level;
+	s->seq.store (pos + 1, std::memory_order_release);
+	log_wake (ring);
+}
+
+// One line per line of @text, which may or may not end with a newline
+void log_lines (log_level_t level, const char *text)
+{
+	const char *nl;
+
+	while (*text) {
+		nl = strchrnul (text, '\n');
+		log_printf (level, "%.*s", (int) (nl - text), text);
+		text = *nl ? nl + 1 : nl;
+	}
+}
+
+// Wait until the lines logged so far are out, also called at exit
+void log_flush ()
+{
+	size_t tail;
+
+	if (!ring)
+		return;
+
+	std::unique_lock<std::mutex> lock (ring->lock);
+	tail = ring->tail.load (std::memory_order_acquire);
+	while (ring->head.load (std::memory_order_acquire) < tail)
+		ring->drained.wait (lock);
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _LOG_H_
+#define _LOG_H_	1
+
+#define LOG_RING_SLOTS		512	// Lines waiting to be written, a power of 2
+#define LOG_LINE_MAX		256	// Longer lines get truncated
+
+typedef enum {
+	LOG_LEVEL_OFF = -1,
+	LOG_LEVEL_ERROR = 0,
+	LOG_LEVEL_WARNING,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_DEBUG,
+} log_level_t;
+
+/*
+ * Messages are only built when the game was configured with `--enable-log'
+ * (the unit tests always are), and then only those up to the level given
+ * with $TANGORINEBA_LOG, "info" by default, or with log_set_level ().
+ * Otherwise LOG_PRINTF () doesn't even evaluate its arguments
+ */
+#ifdef TANGORINEBA_LOG
+#define LOG_PRINTF(level, ...)	do { if (log_enabled (level)) log_printf (level, __VA_ARGS__); } while (0)
+#define LOG_LINES(level, text)	do { if (log_enabled (level)) log_lines (level, text); } while (0)
+#else
+#define LOG_PRINTF(level, ...)	do { } while (0)
+#define LOG_LINES(level, text)	do { } while (0)
+#endif
+
+bool log_enabled (log_level_t level);
+log_level_t log_set_level (log_level_t level);
+void log_printf (log_level_t level, const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+void log_lines (log_level_t level, const char *text);
+void log_flush ();
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <gtk/gtk.h>
+#include "common.h"
+#include "Validate.h"
+#include "Solver.h"
+
+typedef enum {
+	MONITOR_UNKNOWN = 0,
+	MONITOR_SOLVABLE,
+	MONITOR_STUCK,
+} monitor_status_t;
+
+typedef struct monitor_job_st {
+	uint64_t key;
+	uint64_t filled;
+	uint64_t moons;
+	validate_cons_t cons;
+	GSourceFunc done;
+} monitor_job_t;
+
+/*
+ * Same layout as the hint worker: one job waiting at most, and the answer
+ * for the last board checked. A new job also raises @cancel, so that the
+ * check of a board the player already moved away from stops right there
+ */
+typedef struct monitor_worker_st {
+	std::mutex mutex;
+	std::condition_variable cond;
+	std::atomic<bool> cancel;
+	monitor_job_t job;
+	uint64_t busy_key;		// Board being checked right now
+	uint64_t result_key;		// Board the status below belongs to
+	monitor_status_t result;
+} monitor_worker_t;
+
+static monitor_worker_t *worker = nullptr;
+
+static void monitor_worker (monitor_worker_t *w)
+{
+	monitor_job_t job;
+	int ret;
+	std::unique_lock<std::mutex> lock (w->mutex);
+
+	while (true) {
+		while (!w->job.key)
+			w->cond.wait (lock);
+		job = w->job;
+		w->job.key = 0;
+		w->busy_key = job.key;
+		w->cancel.store (false, std::memory_order_relaxed);
+		lock.unlock ();
+
+		ret = solver_try_complete (job.filled, job.moons, &job.cons, &w->cancel);
+
+		lock.lock ();
+		w->busy_key = 0;
+		if (ret == SOLVER_CANCELLED)
+			continue;
+
+		w->result_key = job.key;
+		w->result = ret ? MONITOR_SOLVABLE : MONITOR_STUCK;
+		if (job.done)
+			g_idle_add (job.done, nullptr);
+	}
+}
+
+/*
+ * Check the board known as @key (which must not be 0) in the background,
+ * giving up on whatever board was being checked before, and call @done
+ * from the main loop once the status of @key is known
+ */
+void monitor_check (uint64_t key, uint64_t filled, uint64_t moons, const validate_cons_t *cons, GSourceFunc done)
+{
+	if (!worker) {
+		worker = new monitor_worker_t ();
+		std::thread (monitor_worker, worker).detach ();
+	}
+
+	std::lock_guard<std::mutex> lock (worker->mutex);
+
+	if (key == worker->result_key || key == worker->busy_key || key == worker->job.key)
+		return;
+
+	if (worker->busy_key)
+		worker->cancel.store (true, std::memory_order_relaxed);
+	worker->job.key = key;
+	worker->job.filled = filled;
+	worker->job.moons = moons;
+	worker->job.cons = *cons;
+	worker->job.done = done;
+	worker->cond.notify_one ();
+}
+
+monitor_status_t monitor_get_status (uint64_t key)
+{
+	if (!worker)
+		return MONITOR_UNKNOWN;
+
+	std::lock_guard<std::mutex> lock (worker->mutex);
+
+	return (key == worker->result_key) ? worker->result : MONITOR_UNKNOWN;
+}
@@ -17,17 +17,18 @@
  *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-#ifndef _DIGRAPH_H_
-#define _DIGRAPH_H_	1
-#include <list>
+#ifndef _MONITOR_H_
+#define _MONITOR_H_	1
+#include <stdint.h>
+#include <gtk/gtk.h>
+#include "Validate.h"
 
-typedef struct _digraph_st {
-	int a;
-	int b;
-	int c;
-	int d;
-	int name[4];
-} digraph_t;
+typedef enum {
+	MONITOR_UNKNOWN = 0,	// Not checked yet, or still being checked
+	MONITOR_SOLVABLE,	// Some completion of the guess is a valid board
+	MONITOR_STUCK,		// The guess can no longer be completed
+} monitor_status_t;
 
-std::list<digraph_t> *digraph_get_paths (int **inmtx, int dim, int a, int b, int c, int d);
+void monitor_check (uint64_t key, uint64_t filled, uint64_t moons, const validate_cons_t *cons, GSourceFunc done);
+monitor_status_t monitor_get_status (uint64_t key);
 #endif
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <gtk/gtk.h>
+#include "Board.h"
+#include "Puzzle.h"
+#include "Validate.h"
+#include "Symmetry.h"
+#include "Log.h"
+
+/*
+ * tangorine-pack: builds pack files out of consecutive seeds, and dumps
+ * single records for inspection. Boards which are a rotation, a reflection
+ * or a sun/moon swap of another one in the pack (or in the packs given
+ * with -x) are skipped, and the next seed is tried instead. Packs can be
+ * rendered as PNG thumbnails as well, without a display. The widgets below
+ * are never created, but the rest of the game expects them to be defined
+ */
+GtkWidget *main_window, *da, *time_da;
+GtkWidget *undo_btn, *redo_btn;
+Board board (nullptr);
+
+static void usage (const char *argv0)
+{
+	fprintf (stderr, "Usage: %s [-g GIVENS] [-u] [-x PACK]... create FILE COUNT [FIRST_SEED]\n", argv0);
+	fprintf (stderr, "       %s show FILE N\n", argv0);
+	fprintf (stderr, "       %s [-j JOBS] render FILE DIR [SIZE]\n", argv0);
+}
+
+// Add every board of an existing pack to @index, so that they don't get generated again
+static bool exclude_pack (symmetry_index_t *index, const char *path)
+{
+	pack_t *pack;
+
+	if (!(pack = pack_open (path))) {
+		fprintf (stderr, "%s: not a valid pack file\n", path);
+		return false;
+	}
+
+	for (uint64_t i = 0; i < pack->count; i++)
+		symmetry_index_insert (index, pack_get (pack, i));
+	pack_close (pack);
+
+	return true;
+}
+
+static int create_pack (const char *path, long count, long first_seed, symmetry_index_t *index)
+{
+	std::vector<puzzle_rec_t> recs (count);
+	std::vector<validate_cand_t> cands (count);
+	std::vector<uint64_t> results (count);
+	log_level_t level;
+	size_t nvalid;
+	long i, seed, nskipped = 0;
+
+	// generate () and friends are rather chatty, so only warnings get through meanwhile
+	level = log_set_level (LOG_LEVEL_WARNING);
+	for (i = 0, seed = first_seed; i < count; seed++) {
+		board.generate ((int) seed);
+		board.save_puzzle (&recs[i]);
+		if (!symmetry_index_insert (index, &recs[i])) {
+			nskipped++;
+			continue;
+		}
+		cands[i].filled = ((uint64_t) 1 << 36) - 1;
+		cands[i].moons = recs[i].solution;
+		i++;
+	}
+	log_set_level (level);
+	if (nskipped)
+		fprintf (stderr, "%ld duplicate boards skipped\n", nskipped);
+
+	// Constraints follow from the solutions, so only the rules are worth checking
+	if ((nvalid = validate_boards (cands.data (), count, nullptr, results.data (), 0)) != (size_t) count) {
+		for (i = 0; i < count; i++)
+			if (results[i])
+				fprintf (stderr, "seed %u: the solution breaks the rules (0x%09llx)\n",
+					 recs[i].seed, (unsigned long long) results[i]);
+		return 1;
+	}
+
+	if (!pack_write (path, recs.data (), count)) {
+		perror (path);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int show_puzzle (const char *path, long n)
+{
+	pack_t *pack;
+	const puzzle_rec_t *rec;
+	int i, edge, cell_0, cell_1;
+
+	if (!(pack = pack_open (path))) {
+		fprintf (stderr, "%s: not a valid pack file\n", path);
+		return 1;
+	}
+
+	if (n < 0 || !(rec = pack_get (pack, n))) {
+		fprintf (stderr, "%s: there is no puzzle #%ld (%lu puzzles)\n", path, n, (unsigned long) pack->count);
+		pack_close (pack);
+		return 1;
+	}
+
+	printf ("seed = %u\n", rec->seed);
+	for (i = 0; i < 36; i++) {
+		printf ("%c%c", (rec->solution >> i) & 1 ? 'M' : 'S', (rec->immutable >> i) & 1 ? '*' : ' ');
+		printf ((i % 6) == 5 ? "\n" : " ");
+	}
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		printf ("%d %c %d\n", cell_0, ((rec->solution >> cell_0) & 1) == ((rec->solution >> cell_1) & 1) ? '=' : 'x', cell_1);
+	}
+	pack_close (pack);
+
+	return 0;
+}
+
+/*
+ * Thumbnails are named after the date of boards of the day, and after their
+ * index within the pack otherwise. Every worker has a board and a surface
+ * of its own, so nothing is shared but the index of the next record
+ */
+static void render_worker (const pack_t *pack, const char *dir, int size, std::atomic<uint64_t> *next, std::atomic<uint64_t> *nfailed)
+{
+	uint64_t i;
+	char name[32];
+	const puzzle_rec_t *rec;
+	cairo_surface_t *surface = cairo_image_surface_create (CAIRO_FORMAT_RGB24, size, size);
+	cairo_t *cr = cairo_create (surface);
+	Board b (nullptr);
+
+	while ((i = (*next)++) < pack->count) {
+		rec = pack_get (pack, i);
+		if (rec->date)
+			snprintf (name, sizeof (name), "/%08u.png", rec->date);
+		else
+			snprintf (name, sizeof (name), "/%06llu.png", (unsigned long long) i);
+
+		b.load_puzzle (rec);
+		b.render (cr, size, size);
+		cairo_surface_flush (surface);
+		if (cairo_surface_write_to_png (surface, (std::string (dir) + name).c_str ()) != CAIRO_STATUS_SUCCESS)
+			(*nfailed)++;
+	}
+
+	cairo_destroy (cr);
+	cairo_surface_destroy (surface);
+}
+
+static int render_pack (const char *path, const char *dir, int size, int njobs)
+{
+	pack_t *pack;
+	std::atomic<uint64_t> next (0), nfailed (0);
+	std::vector<std::thread> workers;
+	int i;
+
+	if (!(pack = pack_open (path))) {
+		fprintf (stderr, "%s: not a valid pack file\n", path);
+		return 1;
+	}
+
+	if (njobs < 1)
+		njobs = 1;
+	if ((uint64_t) njobs > pack->count)
+		njobs = pack->count ? pack->count : 1;
+	for (i = 0; i < njobs; i++)
+		workers.push_back (std::thread (render_worker, pack, dir, size, &next, &nfailed));
+	for (i = 0; i < njobs; i++)
+		workers[i].join ();
+	pack_close (pack);
+
+	if (nfailed) {
+		fprintf (stderr, "%s: %llu thumbnails could not be written\n", dir, (unsigned long long) nfailed);
+		return 1;
+	}
+
+	return 0;
+}
+
+int main (int argc, char **argv)
+{
+	int opt, givens = 6, ret, njobs = std::thread::hardware_concurrency ();
+	bool unique = false;
+	const char *argv0 = argv[0];
+	symmetry_index_t *index = symmetry_index_create (0);
+
+	while ((opt = getopt (argc, argv, "+g:j:ux:")) != -1) {
+		switch (opt) {
+		case 'g':
+			givens = atoi (optarg);
+			break;
+		case 'j':
+			njobs = atoi (optarg);
+			break;
+		case 'u':
+			unique = true;
+			break;
+		case 'x':
+			if (!exclude_pack (index, optarg)) {
+				symmetry_index_destroy (index);
+				return 1;
+			}
+			break;
+		default:
+			usage (argv0);
+			symmetry_index_destroy (index);
+			return 1;
+		}
+	}
+	argc -= optind - 1;
+	argv += optind - 1;
+	board.set_givens (givens, unique);
+
+	if (argc >= 4 && !strcmp (argv[1], "create")) {
+		long count = atol (argv[3]);
+
+		if (count <= 0) {
+			usage (argv0);
+			symmetry_index_destroy (index);
+			return 1;
+		}
+		ret = create_pack (argv[2], count, argc >= 5 ? atol (argv[4]) : 1, index);
+		symmetry_index_destroy (index);
+		return ret;
+	}
+	symmetry_index_destroy (index);
+
+	if (argc == 4 && !strcmp (argv[1], "show"))
+		return show_puzzle (argv[2], atol (argv[3]));
+
+	if ((argc == 4 || argc == 5) && !strcmp (argv[1], "render")) {
+		int size = argc == 5 ? atoi (argv[4]) : 120;
+
+		if (size > 0)
+			return render_pack (argv[2], argv[3], size, njobs);
+	}
+
+	usage (argv0);
+	return 1;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <stddef.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PUZZLE_NO_EDGE		63
+#define PUZZLE_MAX_CONS		8
+
+typedef struct puzzle_rec_st {
+	uint64_t solution : 36;
+	uint64_t edges_lo : 24;
+	uint64_t version : 4;
+	uint64_t immutable : 36;
+	uint64_t edges_hi : 24;
+	uint64_t reserved : 4;
+	uint32_t seed;
+	uint32_t date;
+} puzzle_rec_t;
+
+typedef struct pack_header_st {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t count;
+	uint64_t reserved[5];
+} pack_header_t;
+
+typedef struct pack_st {
+	void *map;
+	size_t size;
+	uint64_t count;
+	const puzzle_rec_t *rec;
+} pack_t;
+
+static_assert (sizeof (puzzle_rec_t) == 24, "puzzle_rec_t must be 24 bytes long");
+static_assert (sizeof (pack_header_t) == 64, "pack_header_t must be 64 bytes long");
+
+static const char pack_magic[8] = { 'T', 'G', 'B', 'A', 'P', 'A', 'C', 'K' };
+
+int puzzle_get_edge (const puzzle_rec_t *rec, int n)
+{
+	if (n < 4)
+		return (rec->edges_lo >> (n * 6)) & 0x3f;
+	return (rec->edges_hi >> ((n - 4) * 6)) & 0x3f;
+}
+
+void puzzle_set_edge (puzzle_rec_t *rec, int n, int edge)
+{
+	uint64_t mask;
+
+	if (n < 4) {
+		mask = (uint64_t) 0x3f << (n * 6);
+		rec->edges_lo = (rec->edges_lo & ~mask) | ((uint64_t) edge << (n * 6));
+	} else {
+		mask = (uint64_t) 0x3f << ((n - 4) * 6);
+		rec->edges_hi = (rec->edges_hi & ~mask) | ((uint64_t) edge << ((n - 4) * 6));
+	}
+}
+
+void puzzle_clear (puzzle_rec_t *rec)
+{
+	memset (rec, 0, sizeof (puzzle_rec_t));
+	rec->version = 1;
+	for (int i = 0; i < PUZZLE_MAX_CONS; i++)
+		puzzle_set_edge (rec, i, PUZZLE_NO_EDGE);
+}
+
+void puzzle_get_edge_cells (int edge, int *cell_0, int *cell_1)
+{
+	if (edge < 30) {
+		*cell_0 = (edge / 5) * 6 + edge % 5;
+		*cell_1 = *cell_0 + 1;
+	} else {
+		*cell_0 = edge - 30;
+		*cell_1 = *cell_0 + 6;
+	}
+}
+
+/*
+ * Pack files are never parsed: we just map them in memory and hand out
+ * pointers to the records, so that getting the board #N out of millions
+ * costs one page fault at most. Records are fixed-size, hence the index
+ * of a record is also its position in the file
+ */
+pack_t *pack_open (const char *path)
+{
+	int fd;
+	void *addr;
+	struct stat st;
+	const pack_header_t *hdr;
+	pack_t *pack;
+
+	if ((fd = open (path, O_RDONLY)) == -1)
+		return nullptr;
+
+	if (fstat (fd, &st) == -1 || (size_t) st.st_size < sizeof (pack_header_t)) {
+		close (fd);
+		return nullptr;
+	}
+
+	addr = mmap (nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close (fd);
+	if (addr == MAP_FAILED)
+		return nullptr;
+
+	hdr = (const pack_header_t *) addr;
+	if (memcmp (hdr->magic, pack_magic, sizeof (pack_magic)) || hdr->version != 1 ||
+	    hdr->record_size != sizeof (puzzle_rec_t) ||
+	    hdr->count > (st.st_size - sizeof (pack_header_t)) / sizeof (puzzle_rec_t)) {
+		munmap (addr, st.st_size);
+		return nullptr;
+	}
+
+	pack = new pack_t;
+	pack->map = addr;
+	pack->size = st.st_size;
+	pack->count = hdr->count;
+	pack->rec = (const puzzle_rec_t *) ((const char *) addr + sizeof (pack_header_t));
+	madvise (addr, st.st_size, MADV_RANDOM);
+
+	return pack;
+}
+
+void pack_close (pack_t *pack)
+{
+	if (!pack)
+		return;
+
+	munmap (pack->map, pack->size);
+	delete pack;
+}
+
+const puzzle_rec_t *pack_get (const pack_t *pack, uint64_t n)
+{
+	if (n >= pack->count)
+		return nullptr;
+
+	return &pack->rec[n];
+}
+
+bool pack_write (const char *path, const puzzle_rec_t *recs, uint64_t count)
+{
+	FILE *fp;
+	pack_header_t hdr;
+	bool ret;
+
+	if (!(fp = fopen (path, "wb")))
+		return false;
+
+	memset (&hdr, 0, sizeof (hdr));
+	memcpy (hdr.magic, pack_magic, sizeof (pack_magic));
+	hdr.version = 1;
+	hdr.record_size = sizeof (puzzle_rec_t);
+	hdr.count = count;
+
+	ret = fwrite (&hdr, sizeof (hdr), 1, fp) == 1 &&
+	      fwrite (recs, sizeof (puzzle_rec_t), count, fp) == count;
+	if (fclose (fp))
+		ret = false;
+
+	return ret;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _PUZZLE_H_
+#define _PUZZLE_H_	1
+#include <stddef.h>
+#include <stdint.h>
+
+#define PUZZLE_NUM_EDGES	60	// Interior edges of the board, see puzzle_get_edge_cells ()
+#define PUZZLE_NO_EDGE		63	// Unused constraint slot
+#define PUZZLE_MAX_CONS		8
+
+/*
+ * Binary record of one board (24 bytes). Constraints are stored as indexes
+ * of interior edges; whether they are '=' or 'x' follows from the solution.
+ * Edges 0-29 are horizontal (between cells r * 6 + c and r * 6 + c + 1, with
+ * index r * 5 + c), and edges 30-59 are vertical (between cells r * 6 + c
+ * and (r + 1) * 6 + c, with index 30 + r * 6 + c)
+ */
+typedef struct puzzle_rec_st {
+	uint64_t solution : 36;		// One bit per cell, set for moons
+	uint64_t edges_lo : 24;		// Constraints #0-3, 6 bits each
+	uint64_t version : 4;
+	uint64_t immutable : 36;	// One bit per cell, set for immutable cells
+	uint64_t edges_hi : 24;		// Constraints #4-7, 6 bits each
+	uint64_t reserved : 4;
+	uint32_t seed;
+	uint32_t date;			// YYYYMMDD for boards of the day, 0 otherwise
+} puzzle_rec_t;
+
+// Pack files: a header followed by an array of records, see src/Puzzle.cc
+typedef struct pack_header_st {
+	char magic[8];
+	uint32_t version;
+	uint32_t record_size;
+	uint64_t count;
+	uint64_t reserved[5];
+} pack_header_t;
+
+typedef struct pack_st {
+	void *map;
+	size_t size;
+	uint64_t count;
+	const puzzle_rec_t *rec;
+} pack_t;
+
+void puzzle_clear (puzzle_rec_t *rec);
+int puzzle_get_edge (const puzzle_rec_t *rec, int n);
+void puzzle_set_edge (puzzle_rec_t *rec, int n, int edge);
+void puzzle_get_edge_cells (int edge, int *cell_0, int *cell_1);
+
+pack_t *pack_open (const char *path);
+void pack_close (pack_t *pack);
+const puzzle_rec_t *pack_get (const pack_t *pack, uint64_t n);
+bool pack_write (const char *path, const puzzle_rec_t *recs, uint64_t count);
+#endif
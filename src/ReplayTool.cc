@@ -0,0 +1,178 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <gtk/gtk.h>
+#include "Board.h"
+#include "Journal.h"
+
+/*
+ * tangorine-replay: audits journals written by the game (see src/Journal.cc).
+ * Every move is applied again to a headless board, snapshots are checked
+ * against the moves preceding them, and the final board goes through the
+ * same validation as when playing. Journals are independent of each other,
+ * so they are spread over as many threads as there are CPUs, each one with
+ * its own board. The widgets below are never created, but the rest of the
+ * game expects them to be defined
+ */
+GtkWidget *main_window, *da, *time_da;
+GtkWidget *undo_btn, *redo_btn;
+Board board (nullptr);
+
+typedef enum { REPLAY_SOLVED = 0, REPLAY_UNSOLVED, REPLAY_BOGUS, REPLAY_UNREADABLE } replay_status_t;
+
+typedef struct replay_result_st {
+	replay_status_t status;
+	uint32_t nmoves;
+	int64_t elapsed;	// Microseconds, taken from the last move
+} replay_result_t;
+
+static const char *status_str[] = { "solved", "not solved", "bogus", "unreadable" };
+
+static void usage (const char *argv0)
+{
+	fprintf (stderr, "Usage: %s [-j JOBS] [-q] JOURNAL...\n", argv0);
+}
+
+/*
+ * A journal is bogus when it couldn't have been written by the game: moves
+ * out of order or back in time, snapshots not matching the moves, or a
+ * game claimed to be over on a board which is not solved
+ */
+static replay_status_t replay_one (Board& b, const char *path, replay_result_t *res)
+{
+	int row, col, nsuns, nmoons;
+	uint32_t n;
+	bool claimed = false, solved;
+	const journal_rec_t *rec, *snap;
+	journal_t *j;
+	replay_status_t ret = REPLAY_BOGUS;
+
+	res->nmoves = 0;
+	res->elapsed = 0;
+	if (!(j = journal_open (path)))
+		return REPLAY_UNREADABLE;
+
+	b.load_puzzle (&j->hdr->puzzle);
+	for (n = 0; n < j->nmoves; n++) {
+		rec = journal_get_move (j, n);
+		if (claimed || rec->nmove != n + 1 || rec->time < res->elapsed || !b.apply_journal_move (rec))
+			goto out;
+
+		if (rec->type == JOURNAL_END)
+			claimed = true;
+		res->elapsed = rec->time;
+
+		if (!((n + 1) % j->hdr->interval)) {
+			snap = journal_get_snapshot (j, n + 1);
+			if (!snap || snap->type != JOURNAL_SNAPSHOT ||
+			    snap->snapshot != journal_pack (b.get_immutable (), b.get_filled (), b.get_moons ()))
+				goto out;
+		}
+	}
+	res->nmoves = n;
+
+	for (n = 0; n < 6; n++) {
+		b.validate_row (n);
+		b.validate_col (n);
+	}
+
+	// Constraints are not checked by is_valid (), but they are hatched
+	solved = b.get_num_filled () == 36 && !b.is_valid (&row, &col, &nsuns, &nmoons, false) && !b.get_hatching ();
+	if (claimed && !solved)
+		goto out;
+	ret = solved ? REPLAY_SOLVED : REPLAY_UNSOLVED;
+out:
+	journal_close (j);
+	return ret;
+}
+
+static void replay_worker (char **paths, int npaths, std::atomic<int> *next, replay_result_t *results)
+{
+	int i;
+	Board b (nullptr);
+
+	while ((i = (*next)++) < npaths)
+		results[i].status = replay_one (b, paths[i], &results[i]);
+}
+
+int main (int argc, char **argv)
+{
+	int i, opt, njobs = std::thread::hardware_concurrency ();
+	int count[4] = { 0, 0, 0, 0 };
+	bool quiet = false;
+	std::atomic<int> next (0);
+	std::vector<std::thread> workers;
+
+	while ((opt = getopt (argc, argv, "j:q")) != -1) {
+		switch (opt) {
+		case 'j':
+			njobs = atoi (optarg);
+			break;
+		case 'q':
+			quiet = true;
+			break;
+		default:
+			usage (argv[0]);
+			return 2;
+		}
+	}
+
+	if (optind >= argc || njobs < 0) {
+		usage (argv[0]);
+		return 2;
+	}
+
+	argc -= optind;
+	argv += optind;
+	if (njobs < 1)
+		njobs = 1;
+	if (njobs > argc)
+		njobs = argc;
+
+	std::vector<replay_result_t> results (argc);
+	for (i = 0; i < njobs; i++)
+		workers.push_back (std::thread (replay_worker, argv, argc, &next, results.data ()));
+	for (i = 0; i < njobs; i++)
+		workers[i].join ();
+
+	for (i = 0; i < argc; i++) {
+		const replay_result_t& r = results[i];
+
+		count[r.status]++;
+		if (quiet)
+			continue;
+		if (r.status <= REPLAY_UNSOLVED)
+			printf ("%s: %s, %u moves in %lld:%02lld.%03lld\n", argv[i], status_str[r.status], r.nmoves,
+				(long long) (r.elapsed / 60000000), (long long) (r.elapsed / 1000000 % 60),
+				(long long) (r.elapsed / 1000 % 1000));
+		else
+			printf ("%s: %s\n", argv[i], status_str[r.status]);
+	}
+	printf ("%d journals: %d solved, %d not solved, %d bogus, %d unreadable\n",
+		argc, count[REPLAY_SOLVED], count[REPLAY_UNSOLVED], count[REPLAY_BOGUS], count[REPLAY_UNREADABLE]);
+
+	return count[REPLAY_SOLVED] == argc ? 0 : 1;
+}
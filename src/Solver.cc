@@ -0,0 +1,285 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include "common.h"
+#include "Puzzle.h"
+#include "Validate.h"
+#include "Zobrist.h"
+
+#define SOLVER_NUM_ROWS		14
+#define SOLVER_TABLE_SLOTS	65536
+#define SOLVER_CANCEL_STRIDE	1024
+#define SOLVER_CANCELLED	(-1)
+
+// Everything the search needs to know about the puzzle, one byte per row
+typedef struct solver_st {
+	uint8_t given_mask[6];
+	uint8_t given_val[6];
+	uint8_t hor_equal[6];		// Bit c: cells c and c + 1 hold the same shape
+	uint8_t hor_diff[6];
+	uint8_t ver_equal[6];		// Bit c: cell c and the one below hold the same shape
+	uint8_t ver_diff[6];
+	uint8_t row[6];
+	uint8_t nrows;
+	uint8_t rows[SOLVER_NUM_ROWS];
+	int limit;
+	int count;
+	uint64_t *sols;
+	uint64_t salt;			// Tells this puzzle apart in the transposition table
+} solver_t;
+
+/*
+ * Fill @rows with the valid rows, bit c being set for a moon on column c.
+ * Rows are checked against the rules of the game once and for all, so the
+ * search only has to care about columns and constraints
+ */
+int solver_get_rows (uint8_t *rows)
+{
+	int p, c, n = 0;
+
+	for (p = 0; p < 64; p++) {
+		if (__builtin_popcount (p) != 3)
+			continue;
+
+		for (c = 0; c < 4; c++)
+			if (((p >> c) & 7) == 0 || ((p >> c) & 7) == 7)
+				break;
+		if (c == 4)
+			rows[n++] = p;
+	}
+
+	return n;
+}
+
+static bool solver_fits (const solver_t *s, int r, int p)
+{
+	int i, moons;
+	uint8_t same;
+
+	if ((p & s->given_mask[r]) != s->given_val[r])
+		return false;
+
+	same = ~(p ^ (p >> 1)) & 0x1f;
+	if ((same & s->hor_diff[r]) || (~same & s->hor_equal[r] & 0x1f))
+		return false;
+
+	if (!r)
+		return true;
+
+	same = ~(s->row[r - 1] ^ p) & 0x3f;
+	if ((same & s->ver_diff[r - 1]) || (~same & s->ver_equal[r - 1] & 0x3f))
+		return false;
+
+	if (r >= 2 && (same & ~(s->row[r - 2] ^ s->row[r - 1])))
+		return false;
+
+	// No more than 3 moons and 3 suns per column
+	for (i = 0; i < 6; i++) {
+		moons = 0;
+		for (int k = 0; k < r; k++)
+			moons += (s->row[k] >> i) & 1;
+		moons += (p >> i) & 1;
+		if (moons > 3 || r + 1 - moons > 3)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Counts of solutions below a partial grid, shared by every search. What is
+ * left to place only depends on the rows still to come, the last two rows
+ * and how many moons each column holds, so that's all the key is made of
+ */
+static zobrist_table_t *solver_get_table ()
+{
+	static zobrist_table_t *table = zobrist_table_create (SOLVER_TABLE_SLOTS);
+
+	return table;
+}
+
+static uint64_t solver_get_key (const solver_t *s, int r)
+{
+	int i, k, moons;
+	uint64_t state = r | (s->row[r - 2] << 3) | (s->row[r - 1] << 9);
+
+	for (i = 0; i < 6; i++) {
+		for (k = 0, moons = 0; k < r; k++)
+			moons += (s->row[k] >> i) & 1;
+		state |= (uint64_t) moons << (15 + i * 2);
+	}
+
+	return zobrist_mix (s->salt ^ state);
+}
+
+static void solver_search (solver_t *s, int r)
+{
+	int i, k, before = s->count;
+	uint64_t sol, key = 0, count;
+
+	if (r == 6) {
+		if (s->sols) {
+			for (k = 0, sol = 0; k < 6; k++)
+				sol |= (uint64_t) s->row[k] << (k * 6);
+			s->sols[s->count] = sol;
+		}
+		s->count++;
+		return;
+	}
+
+	// Solutions themselves can't be taken from the table, only their number
+	if (!s->sols && r >= 2 && r <= 4) {
+		key = solver_get_key (s, r);
+		if (zobrist_table_probe (solver_get_table (), key, &count)) {
+			s->count = (int) std::min ((uint64_t) s->limit, s->count + count);
+			return;
+		}
+	}
+
+	for (i = 0; i < s->nrows && s->count < s->limit; i++) {
+		if (!solver_fits (s, r, s->rows[i]))
+			continue;
+		s->row[r] = s->rows[i];
+		solver_search (s, r + 1);
+	}
+
+	// Unless the limit cut it short, the whole subtree has been counted
+	if (key && s->count < s->limit)
+		zobrist_table_store (solver_get_table (), key, s->count - before);
+}
+
+/*
+ * Count the solutions of @rec, stopping as soon as @limit of them are
+ * found. If @sols is not nullptr, it receives the solutions themselves
+ */
+int solver_count (const puzzle_rec_t *rec, int limit, uint64_t *sols)
+{
+	int i, n, edge, cell_0, cell_1;
+	uint64_t m, words[5] = { };
+	bool equal;
+	solver_t s;
+
+	memset (&s, 0, sizeof (s));
+	s.nrows = solver_get_rows (s.rows);
+	s.limit = limit;
+	s.sols = sols;
+
+	for (m = rec->immutable; m; ) {
+		n = pop_cell (&m);
+		s.given_mask[n / 6] |= 1 << (n % 6);
+		if ((rec->solution >> n) & 1)
+			s.given_val[n / 6] |= 1 << (n % 6);
+	}
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		equal = ((rec->solution >> cell_0) & 1) == ((rec->solution >> cell_1) & 1);
+		if (edge < 30)
+			(equal ? s.hor_equal : s.hor_diff)[cell_0 / 6] |= 1 << (cell_0 % 6);
+		else
+			(equal ? s.ver_equal : s.ver_diff)[cell_0 / 6] |= 1 << (cell_0 % 6);
+	}
+
+	// Givens and constraints are the 36 bytes at the start of solver_t
+	memcpy (words, &s, 36);
+	for (i = 0; i < 5; i++)
+		s.salt = zobrist_mix (s.salt ^ words[i]);
+	if (limit > 0)
+		solver_search (&s, 0);
+
+	return s.count;
+}
+
+static std::vector<uint64_t> solver_enumerate ()
+{
+	puzzle_rec_t rec;
+	std::vector<uint64_t> grids;
+
+	puzzle_clear (&rec);
+	grids.resize (solver_count (&rec, 1 << 30, nullptr));
+	solver_count (&rec, grids.size (), grids.data ());
+	std::sort (grids.begin (), grids.end ());
+
+	return grids;
+}
+
+/*
+ * Every valid solution of an empty board (there are 11222 of them), sorted.
+ * The table is built by the first caller in a few milliseconds, and then
+ * shared by every thread
+ */
+size_t solver_get_grids (const uint64_t **grids)
+{
+	static const std::vector<uint64_t> table = solver_enumerate ();
+
+	*grids = table.data ();
+	return table.size ();
+}
+
+/*
+ * Whether some valid grid agrees with every filled cell and honors @cons
+ * (which may be nullptr): 1 if so, 0 if not, and SOLVER_CANCELLED if @cancel
+ * got set in the meantime. The table is scanned 8 grids at a time without
+ * branches, and only the blocks with a candidate are checked any further
+ */
+int solver_try_complete (uint64_t filled, uint64_t moons, const validate_cons_t *cons, const std::atomic<bool> *cancel)
+{
+	typedef uint64_t grid_lanes_t __attribute__ ((vector_size (16)));
+	const uint64_t *grids;
+	size_t i, k, count = solver_get_grids (&grids);
+	grid_lanes_t g, hit, none = { 0, 0 };
+
+	moons &= filled;
+	for (i = 0; i + 8 <= count; i += 8) {
+		if (cancel && !(i % SOLVER_CANCEL_STRIDE) && cancel->load (std::memory_order_relaxed))
+			return SOLVER_CANCELLED;
+
+		hit = none;
+		for (k = 0; k < 8; k += 2) {
+			memcpy (&g, &grids[i + k], sizeof (g));
+			hit |= (grid_lanes_t) (((g & filled) ^ moons) == 0);
+		}
+		if (!(hit[0] | hit[1]))
+			continue;
+
+		for (k = i; k < i + 8; k++)
+			if (!((grids[k] & filled) ^ moons) &&
+			    (!cons || !validate_board (((uint64_t) 1 << 36) - 1, grids[k], cons)))
+				return 1;
+	}
+
+	for (; i < count; i++)
+		if (!((grids[i] & filled) ^ moons) &&
+		    (!cons || !validate_board (((uint64_t) 1 << 36) - 1, grids[i], cons)))
+			return 1;
+
+	return 0;
+}
+
+bool solver_can_complete (uint64_t filled, uint64_t moons, const validate_cons_t *cons)
+{
+	return solver_try_complete (filled, moons, cons, nullptr) > 0;
+}
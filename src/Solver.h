@@ -0,0 +1,42 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _SOLVER_H_
+#define _SOLVER_H_	1
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "Puzzle.h"
+#include "Validate.h"
+
+#define SOLVER_NUM_ROWS		14	// Rows with 3 suns, 3 moons and no three adjacent shapes
+#define SOLVER_CANCEL_STRIDE	1024	// Grids scanned between two looks at the cancel flag
+#define SOLVER_CANCELLED	(-1)
+
+/*
+ * Solutions are given as in puzzle_rec_t: one bit per cell, set for moons.
+ * Givens are the immutable cells of the record, and constraints follow from
+ * its solution
+ */
+int solver_get_rows (uint8_t *rows);
+int solver_count (const puzzle_rec_t *rec, int limit, uint64_t *sols);
+size_t solver_get_grids (const uint64_t **grids);
+bool solver_can_complete (uint64_t filled, uint64_t moons, const validate_cons_t *cons);
+int solver_try_complete (uint64_t filled, uint64_t moons, const validate_cons_t *cons, const std::atomic<bool> *cancel);
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <vector>
+
+#ifdef TANGORINEBA_STEP_TRACE
+class StepTrace {
+public:
+	StepTrace ();
+	StepTrace (StepTrace&) = delete;
+	StepTrace (StepTrace&&) = delete;
+	StepTrace& operator= (StepTrace&) = delete;
+	~StepTrace ();
+
+	void record (int n_step, const std::string& text);
+	std::string get (int n_step) const;
+	void clear ();
+
+private:
+	std::vector<std::string> *steps;
+};
+
+StepTrace step_trace;
+
+// Nothing gets allocated until the first step is recorded
+StepTrace::StepTrace ()
+{
+	steps = nullptr;
+}
+
+StepTrace::~StepTrace ()
+{
+	delete steps;
+}
+
+void StepTrace::record (int n_step, const std::string& text)
+{
+	if (n_step < 0)
+		return;
+
+	if (!steps)
+		steps = new std::vector<std::string>;
+	if ((size_t) n_step >= steps->size ())
+		steps->resize (n_step + 1);
+	(*steps)[n_step] = text;
+}
+
+std::string StepTrace::get (int n_step) const
+{
+	if (!steps || n_step < 0 || (size_t) n_step >= steps->size ())
+		return "";
+
+	return (*steps)[n_step];
+}
+
+void StepTrace::clear ()
+{
+	delete steps;
+	steps = nullptr;
+}
+#endif
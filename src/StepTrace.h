@@ -0,0 +1,48 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _STEPTRACE_H_
+#define _STEPTRACE_H_	1
+#include <string>
+#include <vector>
+
+/*
+ * Board as printed at every step of a unit test. It only exists in test
+ * builds (see test/Makefile.am), so the game never pays for it
+ */
+#ifdef TANGORINEBA_STEP_TRACE
+class StepTrace {
+public:
+	StepTrace ();
+	StepTrace (StepTrace&) = delete;
+	StepTrace (StepTrace&&) = delete;
+	StepTrace& operator= (StepTrace&) = delete;
+	~StepTrace ();
+
+	void record (int n_step, const std::string& text);
+	std::string get (int n_step) const;
+	void clear ();
+
+private:
+	std::vector<std::string> *steps;
+};
+
+extern class StepTrace step_trace;
+#endif
+#endif
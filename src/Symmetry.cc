@@ -0,0 +1,295 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstring>
+#include "common.h"
+#include "Puzzle.h"
+
+#define SYMMETRY_ORDER		16
+
+typedef struct symmetry_key_st {
+	uint64_t lo;
+	uint64_t hi;
+} symmetry_key_t;
+
+typedef struct symmetry_index_st {
+	symmetry_key_t *slot;
+	size_t nslots;
+	size_t count;
+} symmetry_index_t;
+
+/*
+ * A puzzle as four planes of an 8x8 bit matrix, one row of the board per
+ * byte. Constraints are anchored on their first cell: bit c of a row in
+ * @hor joins cells c and c + 1, and bit c of a row in @ver joins that cell
+ * with the one below. Whether they are '=' or 'x' follows from @solution
+ */
+typedef struct symmetry_planes_st {
+	uint64_t solution;
+	uint64_t imm;
+	uint64_t hor;
+	uint64_t ver;
+} symmetry_planes_t;
+
+static uint64_t symmetry_spread (uint64_t mask)
+{
+	uint64_t x = 0;
+
+	for (int r = 0; r < 6; r++)
+		x |= ((mask >> (r * 6)) & 0x3f) << (r * 8);
+
+	return x;
+}
+
+static uint64_t symmetry_gather (uint64_t x)
+{
+	uint64_t mask = 0;
+
+	for (int r = 0; r < 6; r++)
+		mask |= ((x >> (r * 8)) & 0x3f) << (r * 6);
+
+	return mask;
+}
+
+// Hacker's Delight, 7-3: rows become columns
+static uint64_t symmetry_transpose (uint64_t x)
+{
+	x = (x & 0xaa55aa55aa55aa55ull) | ((x & 0x00aa00aa00aa00aaull) << 7) | ((x >> 7) & 0x00aa00aa00aa00aaull);
+	x = (x & 0xcccc3333cccc3333ull) | ((x & 0x0000cccc0000ccccull) << 14) | ((x >> 14) & 0x0000cccc0000ccccull);
+	x = (x & 0xf0f0f0f00f0f0f0full) | ((x & 0x00000000f0f0f0f0ull) << 28) | ((x >> 28) & 0x00000000f0f0f0f0ull);
+
+	return x;
+}
+
+// Bit c of every byte goes to bit 7 - c
+static uint64_t symmetry_mirror8 (uint64_t x)
+{
+	x = ((x >> 1) & 0x5555555555555555ull) | ((x & 0x5555555555555555ull) << 1);
+	x = ((x >> 2) & 0x3333333333333333ull) | ((x & 0x3333333333333333ull) << 2);
+	x = ((x >> 4) & 0x0f0f0f0f0f0f0f0full) | ((x & 0x0f0f0f0f0f0f0f0full) << 4);
+
+	return x;
+}
+
+/*
+ * Element #n of the group: bit 0 mirrors the columns, bit 1 flips the rows,
+ * bit 2 transposes the board and bit 3 swaps suns and moons. Constraints
+ * anchored on the last column (row) of a mirrored (flipped) board move to
+ * the one before, hence the extra shift
+ */
+static void symmetry_apply (symmetry_planes_t *p, int n)
+{
+	uint64_t tmp;
+
+	if (n & 1) {
+		p->solution = (symmetry_mirror8 (p->solution) >> 2) & 0x3f3f3f3f3f3full;
+		p->imm = (symmetry_mirror8 (p->imm) >> 2) & 0x3f3f3f3f3f3full;
+		p->hor = (symmetry_mirror8 (p->hor) >> 3) & 0x1f1f1f1f1f1full;
+		p->ver = (symmetry_mirror8 (p->ver) >> 2) & 0x3f3f3f3f3f3full;
+	}
+
+	if (n & 2) {
+		p->solution = __builtin_bswap64 (p->solution) >> 16;
+		p->imm = __builtin_bswap64 (p->imm) >> 16;
+		p->hor = __builtin_bswap64 (p->hor) >> 16;
+		p->ver = __builtin_bswap64 (p->ver) >> 24;
+	}
+
+	if (n & 4) {
+		p->solution = symmetry_transpose (p->solution);
+		p->imm = symmetry_transpose (p->imm);
+		tmp = symmetry_transpose (p->hor);
+		p->hor = symmetry_transpose (p->ver);
+		p->ver = tmp;
+	}
+
+	if (n & 8)
+		p->solution ^= 0x3f3f3f3f3f3full;
+}
+
+static void symmetry_get_planes (const puzzle_rec_t *rec, symmetry_planes_t *p)
+{
+	int i, edge, cell_0, cell_1;
+	uint64_t hor = 0, ver = 0;
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		*(edge < 30 ? &hor : &ver) |= CELL_BIT (cell_0);
+	}
+
+	p->solution = symmetry_spread (rec->solution);
+	p->imm = symmetry_spread (rec->immutable);
+	p->hor = symmetry_spread (hor);
+	p->ver = symmetry_spread (ver);
+}
+
+// Constraints are stored in ascending order, so that equal puzzles get equal records
+static void symmetry_set_planes (const symmetry_planes_t *p, const puzzle_rec_t *rec, puzzle_rec_t *out)
+{
+	int i = 0, n;
+	uint64_t m;
+
+	puzzle_clear (out);
+	out->solution = symmetry_gather (p->solution);
+	out->immutable = symmetry_gather (p->imm);
+	for (m = symmetry_gather (p->hor); m && i < PUZZLE_MAX_CONS; ) {
+		n = pop_cell (&m);
+		puzzle_set_edge (out, i++, (n / 6) * 5 + n % 6);
+	}
+	for (m = symmetry_gather (p->ver); m && i < PUZZLE_MAX_CONS; ) {
+		n = pop_cell (&m);
+		puzzle_set_edge (out, i++, 30 + n);
+	}
+	out->seed = rec->seed;
+	out->date = rec->date;
+}
+
+void symmetry_transform (const puzzle_rec_t *rec, int n, puzzle_rec_t *out)
+{
+	symmetry_planes_t p;
+
+	symmetry_get_planes (rec, &p);
+	symmetry_apply (&p, n);
+	symmetry_set_planes (&p, rec, out);
+}
+
+static bool symmetry_less (const symmetry_planes_t *a, const symmetry_planes_t *b)
+{
+	if (a->solution != b->solution)
+		return a->solution < b->solution;
+	if (a->imm != b->imm)
+		return a->imm < b->imm;
+	if (a->hor != b->hor)
+		return a->hor < b->hor;
+	return a->ver < b->ver;
+}
+
+/*
+ * The canonical form is the smallest of the 16 images of @rec, comparing
+ * their planes. Seed and date are kept as they are, since they are not part
+ * of the puzzle itself
+ */
+void symmetry_canonicalize (const puzzle_rec_t *rec, puzzle_rec_t *canon)
+{
+	symmetry_planes_t orig, p, best;
+
+	symmetry_get_planes (rec, &orig);
+	best = orig;
+	for (int n = 1; n < SYMMETRY_ORDER; n++) {
+		p = orig;
+		symmetry_apply (&p, n);
+		if (symmetry_less (&p, &best))
+			best = p;
+	}
+	symmetry_set_planes (&best, rec, canon);
+}
+
+static symmetry_key_t symmetry_get_key (const puzzle_rec_t *rec)
+{
+	symmetry_key_t key;
+	puzzle_rec_t canon;
+
+	symmetry_canonicalize (rec, &canon);
+	canon.seed = 0;
+	canon.date = 0;
+	memcpy (&key, &canon, sizeof (key));
+
+	return key;
+}
+
+// Final step of splitmix64, enough to spread keys over the slots
+static size_t symmetry_hash (const symmetry_key_t *key)
+{
+	uint64_t x = key->lo ^ (key->hi * 0x9e3779b97f4a7c15ull);
+
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+	return (size_t) (x ^ (x >> 31));
+}
+
+symmetry_index_t *symmetry_index_create (size_t capacity)
+{
+	symmetry_index_t *index = new symmetry_index_t;
+
+	for (index->nslots = 16; index->nslots < capacity * 2; index->nslots <<= 1)
+		;
+	index->slot = new symmetry_key_t[index->nslots] ();
+	index->count = 0;
+
+	return index;
+}
+
+void symmetry_index_destroy (symmetry_index_t *index)
+{
+	if (!index)
+		return;
+
+	delete[] index->slot;
+	delete index;
+}
+
+// Slot holding @key, or the empty slot where it should go. Keys are never 0
+static size_t symmetry_index_find (const symmetry_index_t *index, const symmetry_key_t *key)
+{
+	size_t n = symmetry_hash (key) & (index->nslots - 1);
+
+	while (index->slot[n].lo || index->slot[n].hi) {
+		if (index->slot[n].lo == key->lo && index->slot[n].hi == key->hi)
+			break;
+		n = (n + 1) & (index->nslots - 1);
+	}
+
+	return n;
+}
+
+bool symmetry_index_contains (const symmetry_index_t *index, const puzzle_rec_t *rec)
+{
+	symmetry_key_t key = symmetry_get_key (rec);
+	size_t n = symmetry_index_find (index, &key);
+
+	return index->slot[n].lo || index->slot[n].hi;
+}
+
+// Returns false if @rec, or any of its images, was already there
+bool symmetry_index_insert (symmetry_index_t *index, const puzzle_rec_t *rec)
+{
+	size_t i, n;
+	symmetry_key_t key = symmetry_get_key (rec), *old;
+
+	n = symmetry_index_find (index, &key);
+	if (index->slot[n].lo || index->slot[n].hi)
+		return false;
+
+	index->slot[n] = key;
+	if (++index->count * 2 <= index->nslots)
+		return true;
+
+	old = index->slot;
+	index->slot = new symmetry_key_t[index->nslots * 2] ();
+	index->nslots *= 2;
+	for (i = 0; i < index->nslots / 2; i++)
+		if (old[i].lo || old[i].hi)
+			index->slot[symmetry_index_find (index, &old[i])] = old[i];
+	delete[] old;
+
+	return true;
+}
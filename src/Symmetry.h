@@ -0,0 +1,51 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _SYMMETRY_H_
+#define _SYMMETRY_H_	1
+#include <stddef.h>
+#include <stdint.h>
+#include "Puzzle.h"
+
+#define SYMMETRY_ORDER		16	// 8 rotations and reflections, times swapping suns and moons
+
+/*
+ * Set of canonical puzzles, keyed by the first 16 bytes of their records
+ * (solution, immutable cells and constraints). Open addressing with linear
+ * probing, grown to keep the load factor below 1/2
+ */
+typedef struct symmetry_key_st {
+	uint64_t lo;
+	uint64_t hi;
+} symmetry_key_t;
+
+typedef struct symmetry_index_st {
+	symmetry_key_t *slot;
+	size_t nslots;		// Always a power of 2
+	size_t count;
+} symmetry_index_t;
+
+void symmetry_transform (const puzzle_rec_t *rec, int n, puzzle_rec_t *out);
+void symmetry_canonicalize (const puzzle_rec_t *rec, puzzle_rec_t *canon);
+
+symmetry_index_t *symmetry_index_create (size_t capacity);
+void symmetry_index_destroy (symmetry_index_t *index);
+bool symmetry_index_contains (const symmetry_index_t *index, const puzzle_rec_t *rec);
+bool symmetry_index_insert (symmetry_index_t *index, const puzzle_rec_t *rec);
+#endif
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <mutex>
+#include <time.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#ifdef TANGORINEBA_TRACE
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TRACE_MAX_EVENTS	65536
+#define TRACE_HIST_BUCKETS	40
+
+typedef enum {
+	TRACE_PREPARE = 0,
+	TRACE_SET_IMMUTABLE_CELLS,
+	TRACE_SET_CONSTRAINTS,
+	TRACE_VALIDATE_ROW,
+	TRACE_VALIDATE_COL,
+	TRACE_IS_VALID,
+	TRACE_DRAW_CB,
+	TRACE_BUTTON_PRESS_CB,
+	TRACE_NUM_PHASES
+} trace_phase_t;
+
+static inline uint64_t trace_now ()
+{
+#if defined (__x86_64__) || defined (__i386__)
+	return __rdtsc ();
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+typedef struct trace_event_st {
+	uint32_t phase;
+	uint32_t tid;
+	uint64_t start;
+	uint64_t ticks;
+} trace_event_t;
+
+typedef struct trace_hist_st {
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> ticks;
+	std::atomic<uint64_t> max;
+	std::atomic<uint64_t> bucket[TRACE_HIST_BUCKETS];
+} trace_hist_t;
+
+/*
+ * Ticks are only turned into time when dumping: the clock read when the
+ * trace starts and again at exit is compared with CLOCK_MONOTONIC over the
+ * same span. This assumes an invariant TSC, as found in every recent x86
+ */
+typedef struct trace_st {
+	trace_event_t event[TRACE_MAX_EVENTS];
+	std::atomic<uint64_t> nevents;
+	std::atomic<uint32_t> nthreads;
+	trace_hist_t hist[TRACE_NUM_PHASES];
+	uint64_t ticks0;
+	uint64_t ns0;
+} trace_t;
+
+static const char *trace_names[TRACE_NUM_PHASES] = {
+	"prepare",
+	"set_immutable_cells",
+	"set_constraints",
+	"validate_row",
+	"validate_col",
+	"is_valid",
+	"draw_cb",
+	"button_press_cb",
+};
+
+static trace_t *trace = nullptr;
+static std::once_flag trace_once;
+static thread_local uint32_t trace_tid = 0;
+
+static uint64_t trace_get_ns ()
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static double trace_ns_per_tick ()
+{
+	uint64_t ticks = trace_now () - trace->ticks0, ns = trace_get_ns () - trace->ns0;
+
+	return ticks ? (double) ns / ticks : 1.0;
+}
+
+static void trace_dump ()
+{
+	const char *path = getenv ("TANGORINEBA_TRACE");
+	double scale = trace_ns_per_tick () / 1000.0;
+	uint64_t i, n = trace->nevents.load (std::memory_order_acquire);
+	FILE *fp;
+	int p, b, first, last;
+
+	if (n > TRACE_MAX_EVENTS)
+		n = TRACE_MAX_EVENTS;
+	if ((fp = fopen (path ? path : "tangorine-trace.json", "w"))) {
+		fprintf (fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+		for (i = 0; i < n; i++) {
+			const trace_event_t& e = trace->event[i];
+
+			fprintf (fp, "%s\n{\"name\":\"%s\",\"cat\":\"TangorineBA\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				 i ? "," : "", trace_names[e.phase], (int) getpid (), e.tid,
+				 (e.start - trace->ticks0) * scale, e.ticks * scale);
+		}
+		fprintf (fp, "\n]}\n");
+		fclose (fp);
+	}
+
+	for (p = 0; p < TRACE_NUM_PHASES; p++) {
+		trace_hist_t& h = trace->hist[p];
+
+		if (!h.count)
+			continue;
+		fprintf (stderr, "%s: %llu calls, mean %.3f us, max %.3f us\n", trace_names[p],
+			 (unsigned long long) h.count, h.ticks * scale / h.count, h.max * scale);
+		for (first = 0; !h.bucket[first]; first++)
+			;
+		for (last = TRACE_HIST_BUCKETS - 1; !h.bucket[last]; last--)
+			;
+		for (b = first; b <= last; b++)
+			fprintf (stderr, "\t< %10.3f us: %llu\n", ((uint64_t) 2 << b) * scale,
+				 (unsigned long long) h.bucket[b]);
+	}
+}
+
+/*
+ * Both clocks are read together, before any probe reads its own start, so
+ * that every event starts at ticks0 or later and no ts comes out negative
+ */
+static void trace_start ()
+{
+	trace = new trace_t ();
+	trace->ticks0 = trace_now ();
+	trace->ns0 = trace_get_ns ();
+	atexit (trace_dump);
+}
+
+// The first probe starts the trace
+void trace_init ()
+{
+	std::call_once (trace_once, trace_start);
+}
+
+void trace_record (trace_phase_t phase, uint64_t start, uint64_t end)
+{
+	uint64_t ticks = end - start, i, max;
+	int b = ticks ? 63 - __builtin_clzll (ticks) : 0;
+
+	if (!trace_tid)
+		trace_tid = trace->nthreads.fetch_add (1, std::memory_order_relaxed) + 1;
+
+	trace_hist_t& h = trace->hist[phase];
+	h.count.fetch_add (1, std::memory_order_relaxed);
+	h.ticks.fetch_add (ticks, std::memory_order_relaxed);
+	h.bucket[b < TRACE_HIST_BUCKETS ? b : TRACE_HIST_BUCKETS - 1].fetch_add (1, std::memory_order_relaxed);
+	max = h.max.load (std::memory_order_relaxed);
+	while (ticks > max && !h.max.compare_exchange_weak (max, ticks, std::memory_order_relaxed))
+		;
+
+	if ((i = trace->nevents.fetch_add (1, std::memory_order_relaxed)) < TRACE_MAX_EVENTS) {
+		trace->event[i].phase = phase;
+		trace->event[i].tid = trace_tid;
+		trace->event[i].start = start;
+		trace->event[i].ticks = ticks;
+	}
+}
+#endif
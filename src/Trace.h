@@ -0,0 +1,86 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _TRACE_H_
+#define _TRACE_H_	1
+#include <stdint.h>
+
+#define TRACE_MAX_EVENTS	65536	// Events kept for the JSON file, the histograms take them all
+#define TRACE_HIST_BUCKETS	40	// Bucket n: from 2^n to 2^(n + 1) - 1 ticks
+
+typedef enum {
+	TRACE_PREPARE = 0,
+	TRACE_SET_IMMUTABLE_CELLS,
+	TRACE_SET_CONSTRAINTS,
+	TRACE_VALIDATE_ROW,
+	TRACE_VALIDATE_COL,
+	TRACE_IS_VALID,
+	TRACE_DRAW_CB,
+	TRACE_BUTTON_PRESS_CB,
+	TRACE_NUM_PHASES
+} trace_phase_t;
+
+/*
+ * Probes only exist in builds configured with `--enable-trace'. Otherwise
+ * TRACE_SCOPE () expands to nothing at all. Events are written at exit to
+ * $TANGORINEBA_TRACE (tangorine-trace.json by default) in the Chrome trace
+ * event format, and a histogram of every phase is printed on stderr
+ */
+#ifdef TANGORINEBA_TRACE
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Raw ticks: the TSC where there is one, and nanoseconds elsewhere
+static inline uint64_t trace_now ()
+{
+#if defined (__x86_64__) || defined (__i386__)
+	return __rdtsc ();
+#else
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+void trace_init ();
+void trace_record (trace_phase_t phase, uint64_t start, uint64_t end);
+
+// Times the scope it is declared in, the trace being started before its clock is read
+class TraceProbe {
+public:
+	TraceProbe (trace_phase_t phase) : phase (phase) { trace_init (); start = trace_now (); }
+	TraceProbe (TraceProbe&) = delete;
+	TraceProbe (TraceProbe&&) = delete;
+	TraceProbe& operator= (TraceProbe&) = delete;
+	~TraceProbe () { trace_record (phase, start, trace_now ()); }
+
+private:
+	trace_phase_t phase;
+	uint64_t start;
+};
+
+#define TRACE_SCOPE(phase)	TraceProbe trace_probe (phase)
+#else
+#define TRACE_SCOPE(phase)
+#endif
+#endif
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstring>
+#include <thread>
+#include <vector>
+#include "common.h"
+#include "Puzzle.h"
+
+#define VALIDATE_THREE_ADJS	0
+#define VALIDATE_BALANCE	12
+#define VALIDATE_CONSTRAINTS	24
+#define VALIDATE_NUM_RULES	3
+#define VALIDATE_RULE(rule)	((rule) / 12)
+#define VALIDATE_BATCH_MIN	4096
+
+typedef uint64_t validate_lanes_t __attribute__ ((vector_size (16)));
+
+typedef struct validate_cons_st {
+	validate_lanes_t equal;
+	validate_lanes_t diff;
+} validate_cons_t;
+
+typedef struct validate_cand_st {
+	uint64_t filled;
+	uint64_t moons;
+} validate_cand_t;
+
+#define LANES(x)	((uint64_t) (x) * 0x0000010101010101ull)	// Same byte on the 6 lanes in use
+#define LANE_HIGH	LANES (0x80)
+
+// One row of a cell mask per byte
+static inline uint64_t validate_spread (uint64_t mask)
+{
+	uint64_t lanes = 0;
+
+	for (int r = 0; r < 6; r++)
+		lanes |= ((mask >> (r * 6)) & 0x3f) << (r * 8);
+
+	return lanes;
+}
+
+// Transpose of an 8x8 bit matrix (Hacker's Delight, 7-3), i.e. rows to columns
+static inline uint64_t validate_transpose (uint64_t x)
+{
+	x = (x & 0xaa55aa55aa55aa55ull) | ((x & 0x00aa00aa00aa00aaull) << 7) | ((x >> 7) & 0x00aa00aa00aa00aaull);
+	x = (x & 0xcccc3333cccc3333ull) | ((x & 0x0000cccc0000ccccull) << 14) | ((x >> 14) & 0x0000cccc0000ccccull);
+	x = (x & 0xf0f0f0f00f0f0f0full) | ((x & 0x00000000f0f0f0f0ull) << 28) | ((x >> 28) & 0x00000000f0f0f0f0ull);
+
+	return x;
+}
+
+static inline validate_lanes_t validate_lanes (uint64_t mask)
+{
+	uint64_t rows = validate_spread (mask);
+	validate_lanes_t lanes = { rows, validate_transpose (rows) };
+
+	return lanes;
+}
+
+// Number of bits set on every byte
+static inline validate_lanes_t validate_popcount (validate_lanes_t x)
+{
+	x = x - ((x >> 1) & 0x5555555555555555ull);
+	x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+
+	return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+}
+
+// Bit n set for every non-zero byte n, rows first. Bytes must be below 0x80
+static inline int validate_movemask (validate_lanes_t x)
+{
+	x = ((x + LANES (0x7f)) & LANE_HIGH) >> 7;
+
+	return (int) ((x[0] * 0x0102040810204080ull) >> 56) | (int) ((x[1] * 0x0102040810204080ull) >> 56) << 6;
+}
+
+void validate_get_cons (const puzzle_rec_t *rec, validate_cons_t *cons)
+{
+	int i, edge, cell_0, cell_1;
+	uint64_t hor_equal = 0, hor_diff = 0, ver_equal = 0, ver_diff = 0;
+	validate_lanes_t hor, ver;
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		if (((rec->solution >> cell_0) & 1) == ((rec->solution >> cell_1) & 1))
+			*(edge < 30 ? &hor_equal : &ver_equal) |= CELL_BIT (cell_0);
+		else
+			*(edge < 30 ? &hor_diff : &ver_diff) |= CELL_BIT (cell_0);
+	}
+
+	// Horizontal constraints only matter to rows, and vertical ones to columns
+	hor = validate_lanes (hor_equal);
+	ver = validate_lanes (ver_equal);
+	cons->equal[0] = hor[0];
+	cons->equal[1] = ver[1];
+	hor = validate_lanes (hor_diff);
+	ver = validate_lanes (ver_diff);
+	cons->diff[0] = hor[0];
+	cons->diff[1] = ver[1];
+}
+
+/*
+ * Smallest sets of cells of a single line (bit c being its c-th cell) that
+ * break each rule, indexed with VALIDATE_RULE (): every run of three equal
+ * shapes, the cells holding a shape that shows up more than three times,
+ * and both cells of every constraint not honored. Unlike the whole-line
+ * results of validate_board (), these tell which cells are to blame
+ */
+void validate_line (uint8_t filled, uint8_t moons, uint8_t equal, uint8_t diff, uint8_t *conflicts)
+{
+	uint8_t suns = filled & ~moons, pair, same, runs, broken;
+
+	moons &= filled;
+	pair = filled & (filled >> 1);
+	same = pair & ~(moons ^ (moons >> 1)) & 0x1f;
+	runs = same & (same >> 1) & 0x0f;
+	broken = ((same & diff) | (pair & ~same & equal)) & 0x1f;
+
+	conflicts[VALIDATE_RULE (VALIDATE_THREE_ADJS)] = runs | (runs << 1) | (runs << 2);
+	conflicts[VALIDATE_RULE (VALIDATE_BALANCE)] = (__builtin_popcount (suns) > 3 ? suns : 0) |
+						      (__builtin_popcount (moons) > 3 ? moons : 0);
+	conflicts[VALIDATE_RULE (VALIDATE_CONSTRAINTS)] = broken | (broken << 1);
+}
+
+/*
+ * Check every row and column of a board at once. Empty cells never break
+ * a rule, so partial boards can be checked as well; a complete board is
+ * solved iff the result is 0. @cons may be nullptr to skip constraints
+ */
+static inline uint64_t validate_one (uint64_t filled, uint64_t moons, const validate_cons_t *cons)
+{
+	validate_lanes_t f = validate_lanes (filled);
+	validate_lanes_t m = validate_lanes (moons);
+	validate_lanes_t pair, same, adjs, balance, broken;
+	uint64_t res;
+
+	// Bit c: cells c and c + 1 of the line are filled with the same shape
+	pair = f & (f >> 1);
+	same = pair & ~(m ^ (m >> 1)) & LANES (0x1f);
+	adjs = same & (same >> 1) & LANES (0x0f);
+
+	balance = ((validate_popcount (m) + LANES (0x7c)) | (validate_popcount (f & ~m) + LANES (0x7c))) & LANE_HIGH;
+
+	res = (uint64_t) validate_movemask (adjs) << VALIDATE_THREE_ADJS;
+	res |= (uint64_t) validate_movemask (balance >> 1) << VALIDATE_BALANCE;
+	if (cons) {
+		broken = (same & cons->diff) | (pair & ~same & cons->equal);
+		res |= (uint64_t) validate_movemask (broken) << VALIDATE_CONSTRAINTS;
+	}
+
+	return res;
+}
+
+uint64_t validate_board (uint64_t filled, uint64_t moons, const validate_cons_t *cons)
+{
+	return validate_one (filled, moons, cons);
+}
+
+// Straight loop over a slice of the candidates, with the kernel inlined
+static size_t validate_range (const validate_cand_t *cands, size_t count, const validate_cons_t *cons,
+			      uint64_t *results)
+{
+	size_t i, nvalid = 0;
+
+	for (i = 0; i < count; i++) {
+		results[i] = validate_one (cands[i].filled, cands[i].moons, cons);
+		nvalid += !results[i];
+	}
+
+	return nvalid;
+}
+
+static void validate_worker (const validate_cand_t *cands, size_t count, const validate_cons_t *cons,
+			     uint64_t *results, size_t *nvalid)
+{
+	*nvalid = validate_range (cands, count, cons, results);
+}
+
+/*
+ * Validate @count candidates at once, all of them sharing @cons (which may
+ * be nullptr), and store the result of validate_board () for each one in
+ * @results. Large batches are split in contiguous slices over @nthreads
+ * threads, or over every CPU when it is 0. Returns the number of boards
+ * breaking no rule at all
+ */
+size_t validate_boards (const validate_cand_t *cands, size_t count, const validate_cons_t *cons,
+			uint64_t *results, int nthreads)
+{
+	size_t i, slice, nvalid = 0;
+	std::vector<size_t> partial;
+	std::vector<std::thread> workers;
+
+	if (nthreads <= 0)
+		nthreads = std::thread::hardware_concurrency ();
+	if ((size_t) nthreads > count / VALIDATE_BATCH_MIN)
+		nthreads = count / VALIDATE_BATCH_MIN;
+	if (nthreads <= 1)
+		return validate_range (cands, count, cons, results);
+
+	slice = (count + nthreads - 1) / nthreads;
+	partial.resize (nthreads);
+	for (i = 0; i < (size_t) nthreads; i++) {
+		size_t first = i * slice, n = first + slice > count ? count - first : slice;
+
+		workers.push_back (std::thread (validate_worker, cands + first, n, cons, results + first, &partial[i]));
+	}
+
+	for (i = 0; i < (size_t) nthreads; i++) {
+		workers[i].join ();
+		nvalid += partial[i];
+	}
+
+	return nvalid;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _VALIDATE_H_
+#define _VALIDATE_H_	1
+#include <stddef.h>
+#include <stdint.h>
+#include "Puzzle.h"
+
+// Offsets of the 12-bit line masks returned by validate_board ()
+#define VALIDATE_THREE_ADJS	0	// Three adjacent identical shapes
+#define VALIDATE_BALANCE	12	// More than three suns or three moons
+#define VALIDATE_CONSTRAINTS	24	// '=' or 'x' not honored
+#define VALIDATE_NUM_RULES	3
+
+// Index of a rule in the masks given by validate_line ()
+#define VALIDATE_RULE(rule)	((rule) / 12)
+
+#define VALIDATE_BATCH_MIN	4096	// Fewer boards than this per thread aren't worth a thread
+
+// Lines of the board failing @rule: rows are bits 0-5, columns bits 6-11
+#define VALIDATE_LINES(res, rule)	((int) (((res) >> (rule)) & 0xfff))
+
+/*
+ * Lanes hold one line of the board per byte, bit c of byte n being the
+ * c-th cell of the line: rows go in the first half and columns in the
+ * second one, so a single 128-bit register covers the whole board
+ */
+typedef uint64_t validate_lanes_t __attribute__ ((vector_size (16)));
+
+// Constraints in lane form, bit c meaning cells c and c + 1 of the line
+typedef struct validate_cons_st {
+	validate_lanes_t equal;
+	validate_lanes_t diff;
+} validate_cons_t;
+
+// A candidate board, as two cell masks
+typedef struct validate_cand_st {
+	uint64_t filled;
+	uint64_t moons;
+} validate_cand_t;
+
+void validate_get_cons (const puzzle_rec_t *rec, validate_cons_t *cons);
+void validate_line (uint8_t filled, uint8_t moons, uint8_t equal, uint8_t diff, uint8_t *conflicts);
+uint64_t validate_board (uint64_t filled, uint64_t moons, const validate_cons_t *cons);
+size_t validate_boards (const validate_cand_t *cands, size_t count, const validate_cons_t *cons,
+			uint64_t *results, int nthreads);
+#endif
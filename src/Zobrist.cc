@@ -0,0 +1,128 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <atomic>
+#include "common.h"
+
+#define ZOBRIST_SEED	0x54474241u	// "TGBA", so every build agrees on the keys
+
+typedef struct zobrist_entry_st {
+	std::atomic<uint64_t> check;
+	std::atomic<uint64_t> value;
+} zobrist_entry_t;
+
+typedef struct zobrist_table_st {
+	zobrist_entry_t *slot;
+	size_t nslots;
+} zobrist_table_t;
+
+typedef struct zobrist_keys_st {
+	uint64_t key[36][2];		// Indexed by cell, then SHAPE_SUN or SHAPE_MOON
+} zobrist_keys_t;
+
+// Finalizer of splitmix64: every bit of @x affects every bit of the result
+uint64_t zobrist_mix (uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+	return x ^ (x >> 31);
+}
+
+/*
+ * Keys come from splitmix64 rather than rand (), which would shift the
+ * sequence of boards generated from a given seed
+ */
+static zobrist_keys_t zobrist_init ()
+{
+	zobrist_keys_t keys;
+	uint64_t state = ZOBRIST_SEED;
+
+	for (int n = 0; n < 36; n++)
+		for (int sh = 0; sh < 2; sh++)
+			keys.key[n][sh] = zobrist_mix (state += 0x9e3779b97f4a7c15ull);
+
+	return keys;
+}
+
+/*
+ * The keys live in a function-local static, since the global board is
+ * built (and may generate a game) before other static objects are
+ */
+uint64_t zobrist_key (int ncell, shape_t shape)
+{
+	static const zobrist_keys_t keys = zobrist_init ();
+
+	return (shape == SHAPE_EMPTY) ? 0 : keys.key[ncell][shape];
+}
+
+// Same value as XORing zobrist_key () for every filled cell
+uint64_t zobrist_hash (uint64_t filled, uint64_t moons)
+{
+	int n;
+	uint64_t hash = 0;
+
+	while (filled) {
+		n = pop_cell (&filled);
+		hash ^= zobrist_key (n, ((moons >> n) & 1) ? SHAPE_MOON : SHAPE_SUN);
+	}
+
+	return hash;
+}
+
+zobrist_table_t *zobrist_table_create (size_t nslots)
+{
+	zobrist_table_t *table = new zobrist_table_t;
+
+	for (table->nslots = 16; table->nslots < nslots; table->nslots <<= 1)
+		;
+	table->slot = new zobrist_entry_t[table->nslots] ();
+
+	return table;
+}
+
+void zobrist_table_destroy (zobrist_table_t *table)
+{
+	if (!table)
+		return;
+
+	delete[] table->slot;
+	delete table;
+}
+
+bool zobrist_table_probe (const zobrist_table_t *table, uint64_t key, uint64_t *value)
+{
+	const zobrist_entry_t *e = &table->slot[key & (table->nslots - 1)];
+	uint64_t check = e->check.load (std::memory_order_relaxed);
+	uint64_t v = e->value.load (std::memory_order_relaxed);
+
+	if (!key || (check ^ v) != key)
+		return false;
+
+	*value = v;
+	return true;
+}
+
+void zobrist_table_store (zobrist_table_t *table, uint64_t key, uint64_t value)
+{
+	zobrist_entry_t *e = &table->slot[key & (table->nslots - 1)];
+
+	e->check.store (key ^ value, std::memory_order_relaxed);
+	e->value.store (value, std::memory_order_relaxed);
+}
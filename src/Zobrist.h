@@ -0,0 +1,55 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef _ZOBRIST_H_
+#define _ZOBRIST_H_	1
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "common.h"
+
+/*
+ * Hash of a board as the XOR of one random key per filled cell and shape,
+ * so that changing a cell only takes two XORs. Empty cells have no key
+ */
+uint64_t zobrist_key (int ncell, shape_t shape);
+uint64_t zobrist_hash (uint64_t filled, uint64_t moons);
+uint64_t zobrist_mix (uint64_t x);
+
+/*
+ * Fixed-size transposition table, shared by any number of threads without
+ * locks. Each slot keeps @value next to @key ^ @value, so a slot torn by
+ * two concurrent stores just fails to match instead of returning garbage.
+ * Newer entries always replace older ones, and key 0 is never found
+ */
+typedef struct zobrist_entry_st {
+	std::atomic<uint64_t> check;	// Key ^ value
+	std::atomic<uint64_t> value;
+} zobrist_entry_t;
+
+typedef struct zobrist_table_st {
+	zobrist_entry_t *slot;
+	size_t nslots;		// Always a power of 2
+} zobrist_table_t;
+
+zobrist_table_t *zobrist_table_create (size_t nslots);
+void zobrist_table_destroy (zobrist_table_t *table);
+bool zobrist_table_probe (const zobrist_table_t *table, uint64_t key, uint64_t *value);
+void zobrist_table_store (zobrist_table_t *table, uint64_t key, uint64_t value);
+#endif
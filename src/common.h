@@ -19,24 +19,49 @@
  */
 #ifndef _COMMON_H_
 #define _COMMON_H_	1
+#include <stdint.h>
 #include <gtk/gtk.h>
 
-// Bitmask of flags for each cell
+/*
+ * Bitmask of flags for each cell, packed in a 16-bit word. Hatchings are
+ * not kept here but in board-wide masks (see Board::set_hatching ()), so
+ * that a whole row or column can be (un)marked at once
+ */
 typedef struct bm_flags_st {
-	unsigned int imm : 1;		// Immutable
-	unsigned int top : 1;		// Top constraint
-	unsigned int top_equal : 1;	// Top must be equal (1) or diff (0) to prev row cell
-	unsigned int right : 1;
-	unsigned int right_equal : 1;
-	unsigned int bottom : 1;
-	unsigned int bottom_equal : 1;
-	unsigned int left : 1;
-	unsigned int left_equal : 1;	// ...
-	unsigned int padding : 23;	// Reserved amount of bits up to complete 32-bit int
-	int claim_for_hor_hatching;	// Horizontal hatching
-	int claim_for_ver_hatching;	// Vertical hatching
+	uint16_t imm : 1;		// Immutable
+	uint16_t top : 1;		// Top constraint
+	uint16_t top_equal : 1;		// Top must be equal (1) or diff (0) to prev row cell
+	uint16_t right : 1;
+	uint16_t right_equal : 1;
+	uint16_t bottom : 1;
+	uint16_t bottom_equal : 1;
+	uint16_t left : 1;
+	uint16_t left_equal : 1;	// ...
+	uint16_t padding : 7;		// Reserved amount of bits up to complete 16-bit word
 } bm_flags_t;
 
+// Board-wide masks hold one bit per cell, bit n being cell n
+#define CELL_BIT(n)	((uint64_t) 1 << (n))
+#define ROW_MASK(r)	((uint64_t) 0x3f << ((r) * 6))
+#define COL_MASK(c)	((uint64_t) 0x041041041 << (c))
+
+/*
+ * Take the lowest cell out of @mask and return its index, so that walking
+ * a mask costs one iteration per set bit:
+ *
+ *	for (m = mask; m; ) {
+ *		n = pop_cell (&m);
+ *		...
+ *	}
+ */
+static inline int pop_cell (uint64_t *mask)
+{
+	int n = __builtin_ctzll (*mask);
+
+	*mask &= *mask - 1;
+	return n;
+}
+
 // Constraints' struct
 typedef struct cons_st {
 	int ncell;
@@ -47,6 +72,7 @@ typedef struct cons_st {
 // Input parsed info only meaningfull for testing (i.e., `make check`)
 typedef struct parsed_st {
 	int seed;		// Random seed
+	uint64_t solution;	// Standard solution, one bit per cell set for moons
 	int imm[6];		// Just 6 cells will be immutable
 	cons_t cons[8];		// Just 8 constraints per board, but one cell can have more than one constraint
 } in_parsed_t;
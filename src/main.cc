@@ -17,14 +17,33 @@
  *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#include <cstdio>
+#include <signal.h>
 #include <gtk/gtk.h>
+#include <glib-unix.h>
 #include "Board.h"
 #include "Callback.h"
+#include "Puzzle.h"
+#include "Hud.h"
 
 GtkWidget *main_window, *da, *time_da;
 GtkWidget *new_game_btn, *clear_game_btn;
-GtkWidget *undo_btn, *redo_btn;
+GtkWidget *undo_btn, *redo_btn, *hint_btn;
 Board board;
+extern bool monitor_moves;
+extern hud_t *hud;
+static char *hud_path = nullptr;
+static pack_t *pack = nullptr;
+static const puzzle_rec_t *puzzle = nullptr;
+
+// `kill -USR1' dumps the frames of the HUD without leaving the game
+static int hud_dump_cb (gpointer data)
+{
+	if (!hud_dump (hud, hud_path))
+		fprintf (stderr, "%s: could not write the frames of the HUD\n", hud_path);
+
+	return true;
+}
 
 void activate (GtkApplication *app, void *data)
 {
@@ -46,6 +65,7 @@ void activate (GtkApplication *app, void *data)
 	clear_game_btn = GTK_WIDGET (gtk_builder_get_object (builder, "clear_game_btn"));
 	undo_btn = GTK_WIDGET (gtk_builder_get_object (builder, "undo_btn"));
 	redo_btn = GTK_WIDGET (gtk_builder_get_object (builder, "redo_btn"));
+	hint_btn = GTK_WIDGET (gtk_builder_get_object (builder, "hint_btn"));
 	gtk_widget_set_sensitive (undo_btn, false);
 	gtk_widget_set_sensitive (redo_btn, false);
 
@@ -59,8 +79,57 @@ void activate (GtkApplication *app, void *data)
 	g_signal_connect (clear_game_btn, "clicked", G_CALLBACK (clear_game_cb), nullptr);
 	g_signal_connect (undo_btn, "clicked", G_CALLBACK (undo_cb), nullptr);
 	g_signal_connect (redo_btn, "clicked", G_CALLBACK (redo_cb), nullptr);
+	g_signal_connect (hint_btn, "clicked", G_CALLBACK (hint_cb), nullptr);
 
 	gtk_widget_show_all (GTK_WIDGET (main_window));
+	if (hud) {
+		gtk_widget_add_tick_callback (da, hud_tick_cb, nullptr, nullptr);
+		if (hud_path)
+			g_unix_signal_add (SIGUSR1, hud_dump_cb, nullptr);
+	}
+
+	if (puzzle)
+		board.play_puzzle (puzzle);
+}
+
+/*
+ * `--givens N' and `--unique' apply to the boards got with the "New" button,
+ * `--pack FILE [--puzzle N]' starts with the board #N of a pack file, and
+ * `--monitor' frames the board in red as soon as a move makes it unsolvable,
+ * and `--hud [--hud-dump FILE]' shows how long frames take to reach the screen
+ */
+int handle_local_options (GApplication *app, GVariantDict *options, void *data)
+{
+	const char *path = nullptr;
+	gint64 n = 0;
+	gint givens = 6;
+	gboolean unique = false, monitor = false, with_hud = false;
+
+	g_variant_dict_lookup (options, "givens", "i", &givens);
+	g_variant_dict_lookup (options, "unique", "b", &unique);
+	board.set_givens (givens, unique);
+	g_variant_dict_lookup (options, "monitor", "b", &monitor);
+	monitor_moves = monitor;
+	g_variant_dict_lookup (options, "hud", "b", &with_hud);
+	g_variant_dict_lookup (options, "hud-dump", "^ay", &hud_path);
+	if (with_hud || hud_path)
+		hud = hud_new ();
+
+	if (!g_variant_dict_lookup (options, "pack", "^&ay", &path))
+		return -1;
+	g_variant_dict_lookup (options, "puzzle", "x", &n);
+
+	if (!(pack = pack_open (path))) {
+		fprintf (stderr, "%s: not a valid pack file\n", path);
+		return 1;
+	}
+
+	if (n < 0 || !(puzzle = pack_get (pack, n))) {
+		fprintf (stderr, "%s: there is no puzzle #%ld (%lu puzzles)\n", path, (long) n, (unsigned long) pack->count);
+		return 1;
+	}
+
+	return -1;
 }
 
 int main (int argc, char **argv)
@@ -69,9 +138,20 @@ int main (int argc, char **argv)
 	int status;
 
 	app = gtk_application_new ("org.gtk.TangorineBA", G_APPLICATION_DEFAULT_FLAGS);
+	g_application_add_main_option (G_APPLICATION (app), "pack", 'p', G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, "Play a board from a pack file", "FILE");
+	g_application_add_main_option (G_APPLICATION (app), "puzzle", 'n', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT64, "Index of the board within the pack (default: 0)", "N");
+	g_application_add_main_option (G_APPLICATION (app), "givens", 'g', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, "Immutable cells of new boards, from 0 to 6 (default: 6)", "N");
+	g_application_add_main_option (G_APPLICATION (app), "unique", 'u', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, "Add immutable cells until new boards have a single solution", nullptr);
+	g_application_add_main_option (G_APPLICATION (app), "monitor", 'm', G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, "Tell as soon as a move makes the board unsolvable", nullptr);
+	g_application_add_main_option (G_APPLICATION (app), "hud", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, "Show input latency, draw time and frame rate over the board", nullptr);
+	g_application_add_main_option (G_APPLICATION (app), "hud-dump", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, "Write the last frames of the HUD to FILE at exit and on SIGUSR1", "FILE");
+	g_signal_connect (app, "handle-local-options", G_CALLBACK (handle_local_options), NULL);
 	g_signal_connect (app, "activate", G_CALLBACK (activate), NULL);
 	status = g_application_run (G_APPLICATION (app), argc, argv);
+	if (hud && hud_path)
+		hud_dump_cb (nullptr);
 	g_object_unref (app);
+	pack_close (pack);
 
 	return status;
 }
@@ -20,15 +20,30 @@
 #include <iostream>
 #include <iomanip>
 #include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
 #include <list>
 #include <gtk/gtk.h>
 #include "../src/common.h"
 #include "../src/Board.h"
 #include "../src/Callback.h"
+#include "../src/StepTrace.h"
+#include "../src/Log.h"
+
+typedef struct packed_board_st {
+	uint64_t filled;
+	uint64_t moons;
+	uint64_t imm;
+	uint64_t hatched;
+	bool operator== (const struct packed_board_st& ref) const;
+} packed_board_t;
 
 typedef struct expected_st {
 	int n_step;
-	std::string exp[6][6];
+	packed_board_t board;
 } expected_t;
 
 extern bool are_there_pending_events;
@@ -60,41 +75,123 @@ public:
 	int get_expected_step (int n_step);
 
 	int pass (int n_step);
+	static packed_board_t pack_board ();
 
 private:
 	std::string in_filename;
 	in_parsed_t *in_parsed;
 	bool input_already_parsed;
 	std::string exp_filename;
-	expected_t *expected;
+	std::vector<expected_t> expected;
 	int total_steps_to_parse;
 	bool expected_already_parsed;
 };
 
-Test::Test ()
+bool packed_board_t::operator== (const packed_board_t& ref) const
 {
-	in_parsed = new in_parsed_t;
-	in_parsed->seed = 0;
-
-	for (int i = 0; i < 6; i++)
-		in_parsed->imm[i] = 0;
-
-	for (int i = 0; i < 8; i++) {
-		in_parsed->cons[i].ncell = 0;
-		in_parsed->cons[i].flags.imm = 0;
-		in_parsed->cons[i].flags.top = 0;
-		in_parsed->cons[i].flags.top_equal = 0;
-		in_parsed->cons[i].flags.right = 0;
-		in_parsed->cons[i].flags.right_equal = 0;
-		in_parsed->cons[i].flags.bottom = 0;
-		in_parsed->cons[i].flags.bottom_equal = 0;
-		in_parsed->cons[i].flags.left = 0;
-		in_parsed->cons[i].flags.left_equal = 0;
-		in_parsed->cons[i].flags.claim_for_hor_hatching = 0;
-		in_parsed->cons[i].flags.claim_for_ver_hatching = 0;
+	return filled == ref.filled && moons == ref.moons && imm == ref.imm && hatched == ref.hatched;
+}
+
+/*
+ * Cursor over a whole fixture, which is read at once and then scanned a
+ * single time. Every helper checks the end of the buffer, so truncated or
+ * malformed files make the parser fail instead of reading past the end
+ */
+typedef struct fixture_st {
+	const char *p;
+	const char *end;
+} fixture_t;
+
+static bool load_fixture (const std::string& filename, std::string& contents)
+{
+	std::ifstream ifile (filename, std::ios::in | std::ios::binary);
+	std::ostringstream ss;
+
+	if (!ifile.is_open ())
+		return false;
+	ss << ifile.rdbuf ();
+	contents = ss.str ();
+
+	return true;
+}
+
+static void skip_blanks (fixture_t& f)
+{
+	while (f.p < f.end && (*f.p == ' ' || *f.p == '\t' || *f.p == ','))
+		f.p++;
+}
+
+static void skip_line (fixture_t& f)
+{
+	while (f.p < f.end && *f.p != '\n')
+		f.p++;
+	if (f.p < f.end)
+		f.p++;
+}
+
+static bool at_eol (fixture_t& f)
+{
+	skip_blanks (f);
+	return f.p == f.end || *f.p == '\n' || *f.p == '\r';
+}
+
+static bool match (fixture_t& f, const char *token)
+{
+	size_t len = strlen (token);
+
+	skip_blanks (f);
+	if ((size_t) (f.end - f.p) < len || memcmp (f.p, token, len))
+		return false;
+	f.p += len;
+
+	return true;
+}
+
+static bool read_int (fixture_t& f, int *n)
+{
+	int v = 0;
+	const char *start;
+
+	skip_blanks (f);
+	for (start = f.p; f.p < f.end && *f.p >= '0' && *f.p <= '9' && f.p - start < 10; f.p++)
+		v = v * 10 + (*f.p - '0');
+	if (f.p == start)
+		return false;
+	*n = v;
+
+	return true;
+}
+
+static bool read_mask (fixture_t& f, const char *name, uint64_t *mask)
+{
+	uint64_t v = 0;
+	const char *start;
+
+	if (!match (f, name) || !match (f, "=") || !match (f, "0x"))
+		return false;
+
+	for (start = f.p; f.p < f.end && f.p - start < 16; f.p++) {
+		if (*f.p >= '0' && *f.p <= '9')
+			v = (v << 4) | (*f.p - '0');
+		else if (*f.p >= 'a' && *f.p <= 'f')
+			v = (v << 4) | (*f.p - 'a' + 10);
+		else
+			break;
 	}
+	if (f.p == start || v >> 36)
+		return false;
+	*mask = v;
+
+	return true;
+}
 
-	expected = new expected_t;
+Test::Test ()
+{
+	in_parsed = new in_parsed_t;
+	memset (in_parsed, 0, sizeof (in_parsed_t));
+	input_already_parsed = false;
+	total_steps_to_parse = 0;
+	expected_already_parsed = false;
 }
 
 Test::~Test ()
@@ -102,109 +199,82 @@ Test::~Test ()
 	delete in_parsed;
 }
 
+/*
+ * Input files are the log printed by the game while generating a board:
+ *
+ *	seed = N
+ *	set_immutable_cells(): c0, c1, c2, c3, c4, c5,
+ *	set_constraints():
+ *	ncell, TOP|RIGHT|BOTTOM|LEFT, =|x	(8 times)
+ */
 bool Test::parse_input (std::string in_filename)
 {
-	int i, j, t, pos;
-	std::fstream ifile;
-	std::string str, aux_str;
-	std::string ncell_str, cons_dir_str, cons_tst_str;
-	char buf[0x40] = { '\0' };
+	int t, ncell;
+	std::string contents;
+	fixture_t f;
 
 	if (!in_filename.length ())
 		return false;
 	this->in_filename = in_filename;
 
-	ifile.open (in_filename, std::ios::in);
-	while (!ifile.eof ()) {
-		/* seed */
-		ifile.getline (buf, 0x40);
-		str = buf;
-		pos = str.find ("seed =");
-		for (i = pos; str[i] != '\0'; i++)
-			if (str[i] >= '0' && str[i] <= '9')
-				aux_str += str[i];
-		in_parsed->seed = atoi (aux_str.c_str ());
-		aux_str.clear ();
-		for (j = 0; j < 0x40; j++)
-			buf[j] = '\0';
-
-		/* set_immutable_cells */
-		ifile.getline (buf, 0x40);
-		str = buf;
-		pos = str.find ("set_immutable_cells(): ");
-		j = 0;
-		for (t = 0, i = pos; str[i] != '\0' && t < 6; i++, t++) {
-			for (; str[j] != ','; j++) {
-				if (str[j] >= '0' && str[j] <= '9')
-					aux_str += str[j];
-			}
-			in_parsed->imm[t] = atoi (aux_str.c_str ());
-			aux_str.clear ();
-			j++;
-		}
-		for (j = 0; j < 0x40; j++)
-			buf[j] = '\0';
-
-		/* set_constraints */
-		ifile.getline (buf, 0x40);
-		str = buf;
-		pos = str.find ("set_constraints():");
-		j = 0;
-		for (t = 0, i = pos; str[i] != '\0' && t < 8; i++, t++) {
-			ifile.getline (buf, 0x80);
-			str = buf;
-			for (j = 0; str[j] != '\0'; j++) {
-				if (str[j] >= '0' && str[j] <= '9')
-					ncell_str += str[j];
-				if (str[j] >= 'A' && str[j] <= 'Z')
-					cons_dir_str += str[j];
-				if (str[j] == '=' || str[j] == 'x')
-					cons_tst_str += str[j];
-			}
-
-			in_parsed->cons[t].ncell = atoi (ncell_str.c_str ());
-
-			if (cons_dir_str == "TOP") {
-				in_parsed->cons[t].flags.top = 1;
-				if (cons_tst_str == "=")
-					in_parsed->cons[t].flags.top_equal = 1;
-				else
-					in_parsed->cons[t].flags.top_equal = 0;
-			}
-
-			if (cons_dir_str == "RIGHT") {
-				in_parsed->cons[t].flags.right = 1;
-				if (cons_tst_str == "=")
-					in_parsed->cons[t].flags.right_equal = 1;
-				else
-					in_parsed->cons[t].flags.right_equal = 0;
-			}
-
-			if (cons_dir_str == "BOTTOM") {
-				in_parsed->cons[t].flags.bottom = 1;
-				if (cons_tst_str == "=")
-					in_parsed->cons[t].flags.bottom_equal = 1;
-				else
-					in_parsed->cons[t].flags.bottom_equal = 0;
-			}
-
-			if (cons_dir_str == "LEFT") {
-				in_parsed->cons[t].flags.left = 1;
-				if (cons_tst_str == "=")
-					in_parsed->cons[t].flags.left_equal = 1;
-				else
-					in_parsed->cons[t].flags.left_equal = 0;
-			}
-
-			ncell_str.clear ();
-			cons_dir_str.clear ();
-			cons_tst_str.clear ();
-			for (j = 0; j < 0x40; j++)
-				buf[j] = '\0';
+	if (!load_fixture (in_filename, contents))
+		return false;
+	f.p = contents.data ();
+	f.end = f.p + contents.size ();
+	memset (in_parsed, 0, sizeof (in_parsed_t));
+
+	if (!match (f, "seed =") || !read_int (f, &in_parsed->seed))
+		return false;
+	skip_line (f);
+
+	if (!match (f, "prepare():") || !read_mask (f, "solution", &in_parsed->solution))
+		return false;
+	skip_line (f);
+
+	if (!match (f, "set_immutable_cells():"))
+		return false;
+	for (t = 0; t < 6; t++) {
+		if (!read_int (f, &ncell) || ncell > 35)
+			return false;
+		in_parsed->imm[t] = ncell;
+	}
+	skip_line (f);
+
+	if (!match (f, "set_constraints():"))
+		return false;
+	skip_line (f);
+
+	for (t = 0; t < 8; t++) {
+		cons_t& cons = in_parsed->cons[t];
+		bool equal;
+
+		if (!read_int (f, &cons.ncell) || cons.ncell > 35)
+			return false;
+
+		if (match (f, "TOP")) {
+			cons.flags.top = 1;
+			equal = match (f, "=");
+			cons.flags.top_equal = equal;
+		} else if (match (f, "RIGHT")) {
+			cons.flags.right = 1;
+			equal = match (f, "=");
+			cons.flags.right_equal = equal;
+		} else if (match (f, "BOTTOM")) {
+			cons.flags.bottom = 1;
+			equal = match (f, "=");
+			cons.flags.bottom_equal = equal;
+		} else if (match (f, "LEFT")) {
+			cons.flags.left = 1;
+			equal = match (f, "=");
+			cons.flags.left_equal = equal;
+		} else {
+			return false;
 		}
-		break;
+
+		if (!equal && !match (f, "x"))
+			return false;
+		skip_line (f);
 	}
-	ifile.close ();
 	input_already_parsed = true;
 
 	return true;
@@ -223,124 +293,52 @@ bool Test::is_input_already_parsed ()
 /*
  * At this point, we have already parsed the input information to recreate
  * the stage for error-proof tests. So now it's time to gather the output
- * information, that is, what we expect to get from stdout and check for
- * identical strings as each unit test is executed.
+ * information, that is, what we expect the board to look like after each
+ * step of the unit test.
  *
  * Note that @exp_filename gets filenames ending in "*.expected" extension.
  * However, it has nothing to do with the dialect Expect which is shipped
  * with Tcl programming language. No pun intended, it's just a coincidence
  *
+ * Every step is one line holding the masks of a packed board, in the same
+ * format Test::pass () prints them, so fixtures can be captured from the
+ * output of a run:
+ *
+ *	n_steps = N
+ *	n_step: filled = 0x..., moons = 0x..., imm = 0x..., hatched = 0x...
  */
 bool Test::parse_expected (std::string exp_filename)
 {
-	int i, j, t, pos, row = 0, col = 0, step;
-	std::fstream ifile;
-	std::string str, aux_str;
-	char buf[0x100] = { '\0' };
+	int i;
+	std::string contents;
+	fixture_t f;
 
 	if (!exp_filename.length ())
 		return false;
 	this->exp_filename = exp_filename;
 
-	ifile.open (exp_filename, std::ios::in);
-	while (!ifile.eof ()) {
-		/* n_steps */
-		ifile.getline (buf, 0x100);
-		str = buf;
-		pos = str.find ("n_steps = ");
-
-		for (i = pos; str[i] != '\0'; i++)
-			if (str[i] >= '0' && str[i] <= '9')
-				aux_str += str[i];
-
-		total_steps_to_parse = atoi (aux_str.c_str ());
-		aux_str.clear ();
-		for (j = 0; j < 0x100; j++)
-			buf[j] = '\0';
-		break;
-	};
-
-	j = 0;
-	this->expected = new expected_t [total_steps_to_parse];
-	while (!ifile.eof ()) {
-		/* steps */
-		ifile.getline (buf, 0x100);
-		str = buf;
-		pos = str.find ("steps: ");
-
-		for (i = pos; str[i] != '\0'; i++) {
-			if (str[i] == ',') {
-				expected[j].n_step = atoi (aux_str.c_str ());
-				aux_str.clear ();
-				j++;
-				continue;
-			}
-			if (str[i] < '0' || str[i] > '9')
-				continue;
-			aux_str += str[i];
-		}
-
-		for (i = 0; i < 0x100; i++)
-			buf[i] = '\0';
-		break;
-	};
-
-	t = 0;
-	pos = 0;
-	step = 0;
-	while (!ifile.eof ()) {
-		/* rows */
-new_step:
-		ifile.getline (buf, 0x100);
-		str = buf;
-		if (str.length () == 1) {
-			step++;
-			str.clear ();
-			goto new_step;
-		}
-
-		if (str.length () == 0)
-			continue;
-
-keep_processing:
-		for (i = pos; str[i] != ' '; i++)
-			if (str[i] >= 0x1b && str[i] <= 0x7f)
-				expected[step].exp[row][col] += str[i];
-		if (str[i] == ' ')
-			col++;
-		if (col == 6) {
-			for (j = 0; j < 0x100; j++)
-				buf[j] = '\0';
-			str.clear ();
-			pos = 0;
-			col = 0;
-			row++;
-		} else {
-			pos = 0;
-			for (i = 0; i < col; i++)
-				pos += expected[step].exp[row][i].length () + 1;
-			goto keep_processing;
-		}
-
-		if (row == 6) {
-			std::cout << "Expected() done: Step n = " << expected[step].n_step << std::endl;
-			for (i = 0; i < 6; i++) {
-				for (j = 0; j < 6; j++)
-					std::cout << expected[step].exp[i][j] << " ";
-				std::cout << std::endl;
-			}
-			std::cout << std::endl;
-			t++;
-			pos = 0;
-			row = 0;
-			col = 0;
-			goto new_step;
-		}
+	if (!load_fixture (exp_filename, contents))
+		return false;
+	f.p = contents.data ();
+	f.end = f.p + contents.size ();
 
-		if (t == total_steps_to_parse)
-			break;
-	};
-	ifile.close ();
+	if (!match (f, "n_steps =") || !read_int (f, &total_steps_to_parse))
+		return false;
+	skip_line (f);
+
+	expected.clear ();
+	expected.resize (total_steps_to_parse);
+	for (i = 0; i < total_steps_to_parse; i++) {
+		expected_t& ref = expected[i];
+
+		if (!read_int (f, &ref.n_step) || !match (f, ":") ||
+		    !read_mask (f, "filled", &ref.board.filled) ||
+		    !read_mask (f, "moons", &ref.board.moons) ||
+		    !read_mask (f, "imm", &ref.board.imm) ||
+		    !read_mask (f, "hatched", &ref.board.hatched) || !at_eol (f))
+			return false;
+		skip_line (f);
+	}
 	expected_already_parsed = true;
 
 	return true;
@@ -366,24 +364,48 @@ int Test::get_expected_step (int n_step)
 	return expected[n_step].n_step;
 }
 
+// Pack the user's guess the same way Board::print () colors it
+packed_board_t Test::pack_board ()
+{
+	packed_board_t b = { 0, 0, 0, 0 };
+	cell_view_t cells = board.view_board (false);
+
+	for (int i = 0; i < cells.size; i++) {
+		const shape_info_t& ref = cells[i];
+		uint64_t bit = (uint64_t) 1 << i;
+
+		if (ref.shape == SHAPE_EMPTY)
+			continue;
+		b.filled |= bit;
+		if (ref.shape == SHAPE_MOON)
+			b.moons |= bit;
+		if (ref.flags.imm)
+			b.imm |= bit;
+		if (board.can_draw_hatching (i))
+			b.hatched |= bit;
+	}
+
+	return b;
+}
+
 int Test::pass (int n_step)
 {
-	int i, j, t;
-	bool ret = false;
-
-	t = n_step;
-	board.print (true, false, t);
-	for (i = 0; i < 6; i++) {
-		for (j = 0; j < 6; j++) {
-			if (expected[t].exp[i][j] == board.get_debug (t, i, j)) {
-				ret = 1;
-			} else {
-				ret = 0;
-				goto out;
-			}
-		}
+	packed_board_t b = pack_board ();
+
+	if (n_step < 0 || n_step >= (int) expected.size ())
+		return 0;
+
+	LOG_PRINTF (LOG_LEVEL_INFO, "%d: filled = 0x%09llx, moons = 0x%09llx, imm = 0x%09llx, hatched = 0x%09llx",
+		    expected[n_step].n_step, (unsigned long long) b.filled, (unsigned long long) b.moons,
+		    (unsigned long long) b.imm, (unsigned long long) b.hatched);
+
+	if (!(expected[n_step].board == b)) {
+#ifdef TANGORINEBA_STEP_TRACE
+		LOG_LINES (LOG_LEVEL_INFO, step_trace.get (n_step).c_str ());
+#endif
+		return 0;
 	}
-out:
-	return ret;
+
+	return 1;
 }
 #include "../src/Stack.h"
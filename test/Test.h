@@ -20,13 +20,24 @@
 #ifndef _TEST_H_
 #define _TEST_H_	1
 #include <string>
+#include <vector>
+#include <stdint.h>
 #include <gtk/gtk.h>
 #include "../src/common.h"
 #include "../src/Stack.h"
 
+// State of the whole board packed as one bit per cell (bit n is cell n)
+typedef struct packed_board_st {
+	uint64_t filled;	// Cells holding a sun or a moon
+	uint64_t moons;
+	uint64_t imm;
+	uint64_t hatched;
+	bool operator== (const struct packed_board_st& ref) const;
+} packed_board_t;
+
 typedef struct expected_st {
 	int n_step;
-	std::string exp[6][6];
+	packed_board_t board;
 } expected_t;
 
 class Test {
@@ -48,13 +59,14 @@ public:
 	int get_expected_step (int n_step);
 
 	int pass (int n_step);
+	static packed_board_t pack_board ();
 
 private:
 	std::string in_filename;
 	in_parsed_t *in_parsed;
 	bool input_already_parsed;
 	std::string exp_filename;
-	expected_t *expected;
+	std::vector<expected_t> expected;
 	int total_steps_to_parse;
 	bool expected_already_parsed;
 };
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../src/Daily.h"
+
+#define CACHE_DIR	"./daily_seed_and_cache.tmp"
+#define DAILY_CACHE_VERSION	5
+
+// Same layout as in src/Daily.cc, to forge a cache written by another build
+typedef struct daily_cache_st {
+	char magic[8];
+	int version;
+	int nslots;
+	int entry_size;
+	int salt;
+	daily_entry_t slot[DAILY_CACHE_SLOTS];
+} daily_cache_t;
+
+static const char daily_magic[8] = { 'T', 'G', 'B', 'A', 'D', 'L', 'Y', '\0' };
+
+static bool check_date (time_t now, int date, int day)
+{
+	int d, n = daily_get_date (now, &d);
+
+	if (n == date && d == day)
+		return true;
+
+	fprintf (stderr, "daily_get_date (%lld): %d (day %d), not %d (day %d)\n", (long long) now, n, d, date, day);
+	return false;
+}
+
+static bool check_seed (int date, const char *salt, int seed)
+{
+	int n = daily_get_seed (date, salt);
+
+	if (n == seed)
+		return true;
+
+	fprintf (stderr, "daily_get_seed (%d, \"%s\"): %d, not %d\n", date, salt, n, seed);
+	return false;
+}
+
+/*
+ * The date rolls over at DAILY_ROLLOVER_HOUR and the seed only depends on
+ * the date and the salt. Then the cache: a board stored is found again, but
+ * not under another date, nor once evicted, and a cache left by a build
+ * with another salt is not trusted at all
+ */
+int main (int argc, char **argv)
+{
+	int date, day;
+	FILE *fp;
+	daily_cache_t forged;
+	daily_entry_t entry;
+	const daily_entry_t *hit;
+	std::string path = std::string (CACHE_DIR) + "/TangorineBA/daily.cache";
+
+	setenv ("TZ", "UTC", 1);
+	tzset ();
+	if (!check_date (1735808399, 20250101, 20089) || !check_date (1735808400, 20250102, 20090) ||
+	    !check_date (1735808400 + 86399, 20250102, 20090))
+		return EXIT_FAILURE;
+
+	if (!check_seed (20250101, "TangorineBA", 487163896) || !check_seed (20250102, "TangorineBA", 732224093) ||
+	    !check_seed (20250102, "pepper", 629901043))
+		return EXIT_FAILURE;
+
+	// Before the cache gets mapped, and the cache directory read
+	setenv ("XDG_CACHE_HOME", CACHE_DIR, 1);
+	mkdir (CACHE_DIR, 0755);
+	mkdir (CACHE_DIR "/TangorineBA", 0755);
+
+	date = daily_get_date (1735808400, &day);
+	memset (&forged, 0, sizeof (forged));
+	memcpy (forged.magic, daily_magic, sizeof (daily_magic));
+	forged.version = DAILY_CACHE_VERSION;
+	forged.nslots = DAILY_CACHE_SLOTS;
+	forged.entry_size = sizeof (daily_entry_t);
+	forged.salt = daily_get_seed (0, TANGORINEBA_DAILY_SALT ", but another one");
+	forged.slot[day % DAILY_CACHE_SLOTS].date = date;
+	forged.slot[day % DAILY_CACHE_SLOTS].day = day;
+	if (!(fp = fopen (path.c_str (), "wb")) || fwrite (&forged, sizeof (forged), 1, fp) != 1 || fclose (fp)) {
+		fprintf (stderr, "%s: could not be written\n", path.c_str ());
+		return EXIT_FAILURE;
+	}
+
+	if (daily_cache_lookup (date, day)) {
+		fprintf (stderr, "the board of another salt was found\n");
+		return EXIT_FAILURE;
+	}
+
+	memset (&entry, 0, sizeof (entry));
+	entry.date = date;
+	entry.day = day;
+	puzzle_clear (&entry.puzzle);
+	entry.puzzle.solution = 0xd342e568b;
+	entry.puzzle.immutable = 0x220102050;
+	entry.puzzle.seed = daily_get_seed (date, TANGORINEBA_DAILY_SALT);
+	entry.puzzle.date = date;
+	if (!daily_cache_store (&entry) || !(hit = daily_cache_lookup (date, day)) || memcmp (hit, &entry, sizeof (entry))) {
+		fprintf (stderr, "the board stored was not found again\n");
+		return EXIT_FAILURE;
+	}
+
+	if (daily_cache_lookup (date + 1, day + 1) || daily_cache_lookup (date - 10000, day)) {
+		fprintf (stderr, "a board was found under another date\n");
+		return EXIT_FAILURE;
+	}
+
+	daily_cache_evict (day + DAILY_CACHE_MAX_AGE, DAILY_CACHE_MAX_AGE);
+	if (!daily_cache_lookup (date, day)) {
+		fprintf (stderr, "a board was evicted too early\n");
+		return EXIT_FAILURE;
+	}
+	daily_cache_evict (day + DAILY_CACHE_MAX_AGE + 1, DAILY_CACHE_MAX_AGE);
+	if (daily_cache_lookup (date, day)) {
+		fprintf (stderr, "an evicted board was found\n");
+		return EXIT_FAILURE;
+	}
+
+	unlink (path.c_str ());
+	rmdir (CACHE_DIR "/TangorineBA");
+	rmdir (CACHE_DIR);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <unistd.h>
+#include <gtk/gtk.h>
+#include "../src/common.h"
+#include "../src/Board.h"
+#include "../src/Journal.h"
+
+#define JOURNAL_PATH	"./journal_snapshot_seek.tmp"
+#define NUM_MOVES	(3 * JOURNAL_SNAPSHOT_INTERVAL + 5)
+
+// Never created, but the rest of the game expects them
+GtkWidget *main_window, *da, *time_da, *undo_btn, *redo_btn;
+Board board (nullptr);
+
+typedef struct state_st {
+	uint64_t filled;
+	uint64_t moons;
+} state_t;
+
+static bool same_state (const Board& b, const state_t& s)
+{
+	return b.get_filled () == s.filled && b.get_moons () == s.moons;
+}
+
+/*
+ * Write a journal of NUM_MOVES random moves, clears included, keeping the
+ * board after every move on the side. Then read it back: every record has
+ * to come out as written, and seeking to move #n through the snapshots has
+ * to give the same board as applying the first n moves one by one, around
+ * and on every multiple of the snapshot interval
+ */
+int main (int argc, char **argv)
+{
+	const uint32_t seek[] = { 0, 1, JOURNAL_SNAPSHOT_INTERVAL - 1, JOURNAL_SNAPSHOT_INTERVAL,
+				  JOURNAL_SNAPSHOT_INTERVAL + 1, 2 * JOURNAL_SNAPSHOT_INTERVAL - 1,
+				  2 * JOURNAL_SNAPSHOT_INTERVAL, 2 * JOURNAL_SNAPSHOT_INTERVAL + 1,
+				  3 * JOURNAL_SNAPSHOT_INTERVAL, NUM_MOVES };
+	int n, ncell;
+	uint32_t i, k;
+	uint64_t imm;
+	shape_t shape;
+	journal_type_t type;
+	puzzle_rec_t rec;
+	journal_writer_t *w;
+	journal_t *j;
+	const journal_rec_t *r, *snap;
+	std::vector<state_t> states (NUM_MOVES + 1);
+	std::vector<journal_rec_t> written (NUM_MOVES);
+	Board b (nullptr), seeked (nullptr);
+
+	srand (1);
+	b.generate (1);
+	b.save_puzzle (&rec);
+	imm = rec.immutable;
+
+	unlink (JOURNAL_PATH);
+	if (!(w = journal_writer_create (JOURNAL_PATH, &rec, JOURNAL_SNAPSHOT_INTERVAL))) {
+		fprintf (stderr, "%s: could not create the journal\n", JOURNAL_PATH);
+		return EXIT_FAILURE;
+	}
+
+	states[0].filled = b.get_filled ();
+	states[0].moons = b.get_moons ();
+	for (i = 0; i < NUM_MOVES; i++) {
+		do
+			ncell = rand () % 36;
+		while (b.is_immutable (ncell));
+
+		shape = (shape_t) (rand () % 3);
+		type = (rand () % 16) ? JOURNAL_MOVE : JOURNAL_CLEAR;
+		memset (&written[i], 0, sizeof (journal_rec_t));
+		written[i].type = type;
+		written[i].ncell = ncell;
+		written[i].shape = shape;
+		written[i].nmove = i + 1;
+		written[i].time = (int64_t) i * 1000;
+		if (!b.apply_journal_move (&written[i])) {
+			fprintf (stderr, "move #%u could not be applied\n", i);
+			return EXIT_FAILURE;
+		}
+
+		states[i + 1].filled = b.get_filled ();
+		states[i + 1].moons = b.get_moons ();
+		if (!journal_writer_append (w, type, ncell, shape, written[i].time, states[i + 1].filled, states[i + 1].moons)) {
+			fprintf (stderr, "move #%u could not be written\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+	journal_writer_close (w);
+
+	if (!(j = journal_open (JOURNAL_PATH)) || j->nmoves != NUM_MOVES ||
+	    memcmp (&j->hdr->puzzle, &rec, sizeof (puzzle_rec_t))) {
+		fprintf (stderr, "%s: header or number of moves differ\n", JOURNAL_PATH);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < NUM_MOVES; i++) {
+		r = journal_get_move (j, i);
+		if (!r || r->type != written[i].type || r->ncell != written[i].ncell || r->shape != written[i].shape ||
+		    r->nmove != written[i].nmove || r->time != written[i].time) {
+			fprintf (stderr, "move #%u does not round-trip\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (n = 0; n < (int) (sizeof (seek) / sizeof (seek[0])); n++) {
+		i = seek[n];
+		k = i - i % JOURNAL_SNAPSHOT_INTERVAL;
+		snap = journal_get_snapshot (j, i);
+		if (k ? (!snap || snap->type != JOURNAL_SNAPSHOT || snap->nmove != k ||
+			 snap->snapshot != journal_pack (imm, states[k].filled, states[k].moons)) : snap != nullptr) {
+			fprintf (stderr, "move #%u: wrong snapshot\n", i);
+			return EXIT_FAILURE;
+		}
+
+		// From scratch, one move after the other
+		b.load_puzzle (&rec);
+		for (k = 0; k < i; k++)
+			b.apply_journal_move (journal_get_move (j, k));
+
+		if (!seeked.replay_journal (j, i) || !same_state (seeked, states[i]) || !same_state (b, states[i])) {
+			fprintf (stderr, "move #%u: seeking and replaying differ\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (seeked.replay_journal (j, NUM_MOVES + 1)) {
+		fprintf (stderr, "seeking past the last move succeeded\n");
+		return EXIT_FAILURE;
+	}
+
+	journal_close (j);
+	unlink (JOURNAL_PATH);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Copyright 2025 Daniel Dwek
+#
+# This file is part of TangorineBA.
+#
+#  TangorineBA is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  TangorineBA is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Three boards go into a pack and come back out one by one: seeds, cells,
+# givens and constraints have to read as they were generated, and there is
+# no fourth one. Building the same seeds again with -x of the first pack has
+# to skip every board as a duplicate and go on with the next seed
+PACK=../src/tangorine-pack
+test -x "$PACK" || exit 77
+
+OUT=pack_create_then_show.out
+trap 'rm -f pack_create_then_show.pack pack_create_then_show_x.pack $OUT' 0
+rm -f pack_create_then_show.pack pack_create_then_show_x.pack
+"$PACK" create pack_create_then_show.pack 3 1 || exit 1
+"$PACK" -x pack_create_then_show.pack create pack_create_then_show_x.pack 3 1 2> $OUT || exit 1
+for n in 0 1 2; do
+	"$PACK" show pack_create_then_show.pack $n >> $OUT || exit 1
+done
+"$PACK" show pack_create_then_show.pack 3 2>> $OUT && exit 1
+"$PACK" show pack_create_then_show_x.pack 0 | sed -n 1p >> $OUT
+diff -u "${srcdir:-.}/pack_create_then_show.expected" $OUT
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Copyright 2025 Daniel Dwek
+#
+# This file is part of TangorineBA.
+#
+#  TangorineBA is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  TangorineBA is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Both journals fill the whole board while one of its '=' or 'x' constraints
+# is broken. The first one stops right there, so it must replay as not
+# solved; the second one goes on until the board is really solved, so a
+# game over wrongly claimed on the full board would make it bogus instead
+REPLAY=../src/tangorine-replay
+test -x "$REPLAY" || exit 77
+
+cd "${srcdir:-.}" || exit 1
+"$OLDPWD/$REPLAY" -j 1 \
+	full_board_broken_constraint.journal \
+	full_board_broken_constraint_then_solved.journal | diff -u replay_full_board_broken_constraint.expected -
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include "../src/common.h"
+#include "../src/Puzzle.h"
+#include "../src/Validate.h"
+#include "../src/Solver.h"
+
+#define NUM_GRIDS	11222
+#define NUM_PARTIALS	2000
+#define FULL_MASK	(((uint64_t) 1 << 36) - 1)
+
+static uint64_t state = 0x9e3779b97f4a7c15ull;
+
+// xorshift64*, so that every run checks the same boards
+static uint64_t next_rand ()
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+/*
+ * Every valid grid the plain way: rows are the 6-bit patterns that
+ * validate_board () accepts on their own, and grids are the stacks of six
+ * such rows it accepts as a whole, sorted as solver_get_grids () does
+ */
+static std::vector<uint64_t> ref_enumerate ()
+{
+	int p, n = 0, k, idx[6] = { };
+	uint8_t rows[64];
+	uint64_t grid;
+	std::vector<uint64_t> grids;
+
+	for (p = 0; p < 64; p++)
+		if (!validate_board (0x3f, p, nullptr) && __builtin_popcount (p) == 3)
+			rows[n++] = p;
+
+	for (;;) {
+		for (k = 0, grid = 0; k < 6; k++)
+			grid |= (uint64_t) rows[idx[k]] << (k * 6);
+		if (!validate_board (FULL_MASK, grid, nullptr))
+			grids.push_back (grid);
+
+		for (k = 5; k >= 0 && ++idx[k] == n; k--)
+			idx[k] = 0;
+		if (k < 0)
+			break;
+	}
+
+	std::sort (grids.begin (), grids.end ());
+	return grids;
+}
+
+// Whether some grid agrees with @filled/@moons and honors @cons, one grid at a time
+static bool ref_can_complete (const uint64_t *grids, size_t count, uint64_t filled, uint64_t moons,
+			      const validate_cons_t *cons)
+{
+	for (size_t i = 0; i < count; i++)
+		if ((grids[i] & filled) == moons && !validate_board (FULL_MASK, grids[i], cons))
+			return true;
+
+	return false;
+}
+
+static bool check_complete (const char *what, uint64_t filled, uint64_t moons, const validate_cons_t *cons,
+			    int expected)
+{
+	std::atomic<bool> cancel (false);
+	int ret = solver_try_complete (filled, moons, cons, &cancel);
+
+	if (ret != expected || solver_can_complete (filled, moons, cons) != (expected > 0)) {
+		fprintf (stderr, "%s (0x%09llx, 0x%09llx): %d, not %d\n", what,
+			 (unsigned long long) filled, (unsigned long long) moons, ret, expected);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * The table of solver_get_grids () against a brute-force enumeration, and
+ * solver_try_complete () against a plain scan of that table, both on
+ * hand-built partial boards and on random ones with random constraints
+ */
+int main (int argc, char **argv)
+{
+	int i, edge, cell_0, cell_1, expected, hits[2] = { };
+	const uint64_t *grids;
+	size_t n, count = solver_get_grids (&grids);
+	uint64_t filled, moons;
+	std::vector<uint64_t> ref = ref_enumerate ();
+	std::atomic<bool> cancel (true);
+	puzzle_rec_t rec;
+	validate_cons_t cons;
+
+	if (count != NUM_GRIDS || ref.size () != NUM_GRIDS) {
+		fprintf (stderr, "%zu grids, %zu by brute force, not %d\n", count, ref.size (), NUM_GRIDS);
+		return EXIT_FAILURE;
+	}
+
+	for (n = 0; n < count; n++) {
+		if (grids[n] != ref[n] || (n && grids[n - 1] >= grids[n])) {
+			fprintf (stderr, "grid #%zu: 0x%09llx, not 0x%09llx\n", n,
+				 (unsigned long long) grids[n], (unsigned long long) ref[n]);
+			return EXIT_FAILURE;
+		}
+		if (validate_board (FULL_MASK, grids[n], nullptr)) {
+			fprintf (stderr, "grid #%zu (0x%09llx) breaks the rules\n", n, (unsigned long long) grids[n]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// The top half of a grid is solvable: the grid itself completes it
+	filled = 0x3ffff;
+	if (!check_complete ("half a grid", filled, grids[count / 2] & filled, nullptr, 1))
+		return EXIT_FAILURE;
+
+	// Suns on cells 0-2 already break a rule, so nothing completes them
+	if (!check_complete ("three suns in a row", 0x7, 0, nullptr, 0))
+		return EXIT_FAILURE;
+
+	/*
+	 * A dead board nothing is wrong with yet: '=' between cells 0 and 1 and
+	 * between cells 1 and 2 leaves room for three identical shapes only
+	 */
+	puzzle_clear (&rec);
+	puzzle_set_edge (&rec, 0, 0);
+	puzzle_set_edge (&rec, 1, 1);
+	validate_get_cons (&rec, &cons);
+	if (validate_board (0, 0, &cons) || !check_complete ("'=' '=' on an empty row", 0, 0, &cons, 0))
+		return EXIT_FAILURE;
+
+	// The same with one 'x' instead is fine
+	rec.solution = 0x1;
+	validate_get_cons (&rec, &cons);
+	if (!check_complete ("'x' '=' on an empty row", 0, 0, &cons, 1))
+		return EXIT_FAILURE;
+
+	// A cancelled search gives up before its first look at the table
+	if (solver_try_complete (0, 0, nullptr, &cancel) != SOLVER_CANCELLED) {
+		fprintf (stderr, "a cancelled search went on\n");
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 * Random subsets of random grids, every other one with a flipped cell,
+	 * and random constraints taken from another grid, which may or may not
+	 * agree with this one
+	 */
+	for (i = 0; i < NUM_PARTIALS; i++) {
+		uint64_t grid = grids[next_rand () % count];
+
+		puzzle_clear (&rec);
+		rec.solution = (i & 2) ? grid : grids[next_rand () % count];
+		for (int k = next_rand () % (PUZZLE_MAX_CONS + 1); k > 0; k--) {
+			edge = next_rand () % PUZZLE_NUM_EDGES;
+			puzzle_set_edge (&rec, k - 1, edge);
+		}
+		validate_get_cons (&rec, &cons);
+
+		filled = next_rand () & next_rand () & FULL_MASK;
+		moons = grid & filled;
+		if ((i & 1) && filled) {
+			puzzle_get_edge_cells (next_rand () % PUZZLE_NUM_EDGES, &cell_0, &cell_1);
+			filled |= CELL_BIT (cell_0);
+			moons ^= CELL_BIT (cell_0);
+		}
+
+		expected = ref_can_complete (grids, count, filled, moons, &cons);
+		hits[expected]++;
+		if (!check_complete ("random board", filled, moons, &cons, expected))
+			return EXIT_FAILURE;
+	}
+
+	if (!hits[0] || !hits[1]) {
+		fprintf (stderr, "random boards never seen %s\n", hits[1] ? "dead" : "solvable");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "../src/common.h"
+#include "../src/Puzzle.h"
+#include "../src/Symmetry.h"
+
+#define NUM_PUZZLES	20000
+#define FULL_MASK	(((uint64_t) 1 << 36) - 1)
+
+static uint64_t state = 0x9e3779b97f4a7c15ull;
+
+// xorshift64*, so that every run checks the same puzzles
+static uint64_t next_rand ()
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+// Random solution, givens and up to PUZZLE_MAX_CONS distinct constraints
+static void random_puzzle (puzzle_rec_t *rec)
+{
+	int i, k, n = next_rand () % (PUZZLE_MAX_CONS + 1), edges[PUZZLE_MAX_CONS];
+
+	puzzle_clear (rec);
+	rec->solution = next_rand () & FULL_MASK;
+	rec->immutable = next_rand () & next_rand () & FULL_MASK;
+	rec->seed = next_rand ();
+	rec->date = next_rand ();
+	for (i = 0; i < n; i++) {
+		do {
+			edges[i] = next_rand () % PUZZLE_NUM_EDGES;
+			for (k = 0; k < i && edges[k] != edges[i]; k++)
+				;
+		} while (k < i);
+		puzzle_set_edge (rec, i, edges[i]);
+	}
+}
+
+// Where element #n of the group sends a cell, the plain way (see symmetry_apply ())
+static int ref_cell (int ncell, int n)
+{
+	int r = ncell / 6, c = ncell % 6, tmp;
+
+	if (n & 1)
+		c = 5 - c;
+	if (n & 2)
+		r = 5 - r;
+	if (n & 4) {
+		tmp = r;
+		r = c;
+		c = tmp;
+	}
+
+	return r * 6 + c;
+}
+
+// Constraints of @rec as a sorted list of cell pairs, lower cell first
+static int get_pairs (const puzzle_rec_t *rec, int n, int *pairs)
+{
+	int i, edge, cell_0, cell_1, count = 0;
+
+	for (i = 0; i < PUZZLE_MAX_CONS; i++) {
+		if ((edge = puzzle_get_edge (rec, i)) >= PUZZLE_NUM_EDGES)
+			continue;
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		cell_0 = ref_cell (cell_0, n);
+		cell_1 = ref_cell (cell_1, n);
+		pairs[count++] = std::min (cell_0, cell_1) * 36 + std::max (cell_0, cell_1);
+	}
+	std::sort (pairs, pairs + count);
+
+	return count;
+}
+
+// Whether @out is image #n of @rec, cell by cell and constraint by constraint
+static bool ref_check (const puzzle_rec_t *rec, int n, const puzzle_rec_t *out)
+{
+	int i, count, pairs[PUZZLE_MAX_CONS], out_pairs[PUZZLE_MAX_CONS];
+	uint64_t solution = 0, imm = 0;
+
+	for (i = 0; i < 36; i++) {
+		if (((rec->solution >> i) & 1) ^ ((n >> 3) & 1))
+			solution |= CELL_BIT (ref_cell (i, n));
+		if ((rec->immutable >> i) & 1)
+			imm |= CELL_BIT (ref_cell (i, n));
+	}
+
+	count = get_pairs (rec, n, pairs);
+	return out->solution == solution && out->immutable == imm && out->seed == rec->seed &&
+	       out->date == rec->date && get_pairs (out, 0, out_pairs) == count &&
+	       !memcmp (pairs, out_pairs, count * sizeof (int));
+}
+
+static bool same_puzzle (const puzzle_rec_t *a, const puzzle_rec_t *b)
+{
+	return !memcmp (a, b, sizeof (puzzle_rec_t));
+}
+
+/*
+ * Every image of a random puzzle has to be what the plain cell mapping
+ * gives, to have the same canonical form as the puzzle itself, and to be
+ * taken by the index for the puzzle already there
+ */
+int main (int argc, char **argv)
+{
+	int i, n;
+	puzzle_rec_t rec, image, canon, image_canon;
+	symmetry_index_t *index = symmetry_index_create (0);
+
+	for (i = 0; i < NUM_PUZZLES; i++) {
+		random_puzzle (&rec);
+		symmetry_canonicalize (&rec, &canon);
+
+		if (!symmetry_index_insert (index, &rec)) {
+			fprintf (stderr, "puzzle #%d: taken for one already seen\n", i);
+			return EXIT_FAILURE;
+		}
+
+		for (n = 0; n < SYMMETRY_ORDER; n++) {
+			symmetry_transform (&rec, n, &image);
+			if (!ref_check (&rec, n, &image)) {
+				fprintf (stderr, "puzzle #%d: image #%d is not what the cell mapping gives\n", i, n);
+				return EXIT_FAILURE;
+			}
+
+			symmetry_canonicalize (&image, &image_canon);
+			if (!same_puzzle (&canon, &image_canon)) {
+				fprintf (stderr, "puzzle #%d: image #%d has another canonical form\n", i, n);
+				return EXIT_FAILURE;
+			}
+
+			if (!symmetry_index_contains (index, &image) || symmetry_index_insert (index, &image)) {
+				fprintf (stderr, "puzzle #%d: image #%d not found in the index\n", i, n);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	if (index->count != NUM_PUZZLES) {
+		fprintf (stderr, "%zu puzzles in the index, not %d\n", index->count, NUM_PUZZLES);
+		return EXIT_FAILURE;
+	}
+	symmetry_index_destroy (index);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../src/common.h"
+#include "../src/Puzzle.h"
+#include "../src/Validate.h"
+
+#define NUM_BOARDS	200000
+
+// Rules broken by one line, worked out cell by cell the plain way
+typedef struct ref_line_st {
+	bool adjs, balance, broken;
+	uint8_t conflicts[VALIDATE_NUM_RULES];
+} ref_line_t;
+
+static uint64_t state = 0x9e3779b97f4a7c15ull;
+
+// xorshift64*, so that every run checks the same boards
+static uint64_t next_rand ()
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+static int line_cell (int line, int c)
+{
+	return line < 6 ? line * 6 + c : c * 6 + line - 6;
+}
+
+static void ref_check_line (uint8_t filled, uint8_t moons, uint8_t equal, uint8_t diff, ref_line_t *ref)
+{
+	int c, nsuns = 0, nmoons = 0;
+
+	memset (ref, 0, sizeof (ref_line_t));
+	for (c = 0; c < 6; c++) {
+		if (!(filled & (1 << c)))
+			continue;
+		if (moons & (1 << c))
+			nmoons++;
+		else
+			nsuns++;
+	}
+
+	for (c = 0; c + 2 < 6; c++) {
+		uint8_t run = 7 << c;
+
+		if ((filled & run) == run && ((moons & run) == run || !(moons & run))) {
+			ref->adjs = true;
+			ref->conflicts[VALIDATE_RULE (VALIDATE_THREE_ADJS)] |= run;
+		}
+	}
+
+	if (nsuns > 3) {
+		ref->balance = true;
+		ref->conflicts[VALIDATE_RULE (VALIDATE_BALANCE)] |= filled & ~moons;
+	}
+	if (nmoons > 3) {
+		ref->balance = true;
+		ref->conflicts[VALIDATE_RULE (VALIDATE_BALANCE)] |= filled & moons;
+	}
+
+	for (c = 0; c + 1 < 6; c++) {
+		uint8_t pair = 3 << c;
+		bool same = ((moons >> c) & 1) == ((moons >> (c + 1)) & 1);
+
+		if ((filled & pair) != pair)
+			continue;
+		if (((equal & (1 << c)) && !same) || ((diff & (1 << c)) && same)) {
+			ref->broken = true;
+			ref->conflicts[VALIDATE_RULE (VALIDATE_CONSTRAINTS)] |= pair;
+		}
+	}
+}
+
+static uint8_t get_line (uint64_t mask, int line)
+{
+	uint8_t bits = 0;
+
+	for (int c = 0; c < 6; c++)
+		if (mask & CELL_BIT (line_cell (line, c)))
+			bits |= 1 << c;
+
+	return bits;
+}
+
+/*
+ * Random solution and up to PUZZLE_MAX_CONS random edges. As with
+ * validate_get_cons (), a constraint is kept on the first of its cells, in
+ * @equal or @diff for its own direction (0 for rows, 1 for columns)
+ */
+static void random_puzzle (puzzle_rec_t *rec, uint64_t *equal, uint64_t *diff)
+{
+	int i, edge, cell_0, cell_1, dir;
+
+	puzzle_clear (rec);
+	rec->solution = next_rand () & (((uint64_t) 1 << 36) - 1);
+	equal[0] = equal[1] = diff[0] = diff[1] = 0;
+	for (i = next_rand () % (PUZZLE_MAX_CONS + 1); i > 0; i--) {
+		edge = next_rand () % PUZZLE_NUM_EDGES;
+		puzzle_set_edge (rec, i - 1, edge);
+		puzzle_get_edge_cells (edge, &cell_0, &cell_1);
+		dir = edge >= 30;
+		if (((rec->solution >> cell_0) & 1) == ((rec->solution >> cell_1) & 1))
+			equal[dir] |= CELL_BIT (cell_0);
+		else
+			diff[dir] |= CELL_BIT (cell_0);
+	}
+}
+
+/*
+ * validate_board () and validate_line () against ref_check_line () on random
+ * full and partial boards with random constraints. Every rule has to show
+ * up both broken and not broken, or the boards prove nothing
+ */
+int main (int argc, char **argv)
+{
+	int i, line, rule, hits[VALIDATE_NUM_RULES][2] = { };
+	uint64_t filled, moons, equal[2], diff[2], res, expected;
+	uint8_t conflicts[VALIDATE_NUM_RULES];
+	puzzle_rec_t rec;
+	validate_cons_t cons;
+	ref_line_t ref;
+	std::vector<validate_cand_t> cands (NUM_BOARDS);
+	std::vector<uint64_t> results (NUM_BOARDS);
+
+	for (i = 0; i < NUM_BOARDS; i++) {
+		random_puzzle (&rec, equal, diff);
+		validate_get_cons (&rec, &cons);
+		filled = (i & 1) ? ((uint64_t) 1 << 36) - 1 : next_rand () & next_rand () >> (i & 6) & (((uint64_t) 1 << 36) - 1);
+
+		// Every caller passes moons on filled cells only
+		moons = next_rand () & filled;
+		cands[i].filled = filled;
+		cands[i].moons = moons;
+
+		res = validate_board (filled, moons, &cons);
+		expected = 0;
+		for (line = 0; line < 12; line++) {
+			uint8_t f = get_line (filled, line), m = get_line (moons, line);
+			uint8_t eq = get_line (equal[line >= 6], line), df = get_line (diff[line >= 6], line);
+
+			ref_check_line (f, m, eq, df, &ref);
+			expected |= (uint64_t) ref.adjs << (VALIDATE_THREE_ADJS + line);
+			expected |= (uint64_t) ref.balance << (VALIDATE_BALANCE + line);
+			expected |= (uint64_t) ref.broken << (VALIDATE_CONSTRAINTS + line);
+			hits[VALIDATE_RULE (VALIDATE_THREE_ADJS)][ref.adjs]++;
+			hits[VALIDATE_RULE (VALIDATE_BALANCE)][ref.balance]++;
+			hits[VALIDATE_RULE (VALIDATE_CONSTRAINTS)][ref.broken]++;
+
+			validate_line (f, m, eq, df, conflicts);
+			for (rule = 0; rule < VALIDATE_NUM_RULES; rule++) {
+				if (conflicts[rule] != ref.conflicts[rule]) {
+					fprintf (stderr, "validate_line (0x%02x, 0x%02x, 0x%02x, 0x%02x): rule %d gives 0x%02x, not 0x%02x\n",
+						 f, m, eq, df, rule, conflicts[rule], ref.conflicts[rule]);
+					return EXIT_FAILURE;
+				}
+			}
+		}
+
+		if (res != expected) {
+			fprintf (stderr, "validate_board (0x%09llx, 0x%09llx): 0x%09llx, not 0x%09llx\n",
+				 (unsigned long long) filled, (unsigned long long) moons,
+				 (unsigned long long) res, (unsigned long long) expected);
+			return EXIT_FAILURE;
+		}
+	}
+
+	for (rule = 0; rule < VALIDATE_NUM_RULES; rule++) {
+		if (!hits[rule][0] || !hits[rule][1]) {
+			fprintf (stderr, "rule %d never seen %s\n", rule, hits[rule][1] ? "honored" : "broken");
+			return EXIT_FAILURE;
+		}
+	}
+
+	// The batch gives the same results, whether split over threads or not
+	for (i = 1; i <= 4; i *= 4) {
+		std::vector<uint64_t> batch (NUM_BOARDS);
+
+		validate_boards (cands.data (), NUM_BOARDS, nullptr, batch.data (), i);
+		for (size_t n = 0; n < NUM_BOARDS; n++) {
+			if (batch[n] != validate_board (cands[n].filled, cands[n].moons, nullptr)) {
+				fprintf (stderr, "validate_boards (%d threads): board %zu differs\n", i, n);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
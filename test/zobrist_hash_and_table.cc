@@ -0,0 +1,221 @@
+/*
+ * Copyright 2025 Daniel Dwek
+ *
+ * This file is part of TangorineBA.
+ *
+ *  TangorineBA is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  TangorineBA is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with TangorineBA.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <gtk/gtk.h>
+#include "../src/common.h"
+#include "../src/Board.h"
+#include "../src/Journal.h"
+#include "../src/Puzzle.h"
+#include "../src/Validate.h"
+#include "../src/Solver.h"
+#include "../src/Zobrist.h"
+
+#define NUM_MOVES	500
+#define NUM_PUZZLES	40
+#define FULL_MASK	(((uint64_t) 1 << 36) - 1)
+
+// Never created, but the rest of the game expects them
+GtkWidget *main_window, *da, *time_da, *undo_btn, *redo_btn;
+Board board (nullptr);
+
+// A move as undo_cb () takes it back: the shape and flags the cell had before
+typedef struct move_st {
+	int ncell;
+	shape_t shape;
+	bm_flags_t flags;
+} move_t;
+
+static uint64_t state = 0x9e3779b97f4a7c15ull;
+
+// xorshift64*, so that every run makes the same moves
+static uint64_t next_rand ()
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 0x2545f4914f6cdd1dull;
+}
+
+/*
+ * Both hashes of @b against what rehash () would give, and against the
+ * plain XOR of the key of every cell, so that zobrist_hash () is checked too
+ */
+static bool check_hashes (const Board& b, const char *what, int n)
+{
+	int i;
+	uint64_t moons = 0, user = 0, sol = 0;
+
+	for (i = 0; i < 36; i++) {
+		if (b.get_solution_shape (i) == SHAPE_MOON)
+			moons |= CELL_BIT (i);
+		sol ^= zobrist_key (i, b.get_solution_shape (i));
+		user ^= zobrist_key (i, b.get_user_shape (i));
+	}
+
+	if (b.get_user_hash () != zobrist_hash (b.get_filled (), b.get_moons ()) || b.get_user_hash () != user ||
+	    b.get_solution_hash () != zobrist_hash (FULL_MASK, moons) || b.get_solution_hash () != sol) {
+		fprintf (stderr, "%s #%d: hashes 0x%016llx/0x%016llx, not 0x%016llx/0x%016llx\n", what, n,
+			 (unsigned long long) b.get_user_hash (), (unsigned long long) b.get_solution_hash (),
+			 (unsigned long long) user, (unsigned long long) sol);
+		return false;
+	}
+
+	return true;
+}
+
+// Solutions of @rec the plain way: the valid grids agreeing with its givens and constraints
+static int ref_count (const puzzle_rec_t *rec)
+{
+	const uint64_t *grids;
+	size_t i, count = solver_get_grids (&grids);
+	int n = 0;
+	validate_cons_t cons;
+
+	validate_get_cons (rec, &cons);
+	for (i = 0; i < count; i++)
+		if (!((grids[i] ^ rec->solution) & rec->immutable) && !validate_board (FULL_MASK, grids[i], &cons))
+			n++;
+
+	return n;
+}
+
+/*
+ * Counts of solver_count () with the transposition table (no solutions
+ * asked for), with the table already warm, and without it (solutions asked
+ * for, which the table can't give), against ref_count ()
+ */
+static bool check_count (const puzzle_rec_t *rec, int n)
+{
+	int expected = ref_count (rec), cold, warm, plain, limited;
+	std::vector<uint64_t> sols (expected + 1);
+
+	cold = solver_count (rec, 1 << 30, nullptr);
+	warm = solver_count (rec, 1 << 30, nullptr);
+	plain = solver_count (rec, expected + 1, sols.data ());
+	limited = solver_count (rec, 2, nullptr);
+	if (cold != expected || warm != expected || plain != expected || limited != std::min (2, expected)) {
+		fprintf (stderr, "puzzle #%d: %d/%d solutions with the table, %d without it, %d up to 2, not %d\n",
+			 n, cold, warm, plain, limited, expected);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * The incremental Zobrist hashes of a board have to match the ones computed
+ * from scratch after every move, every undo, a clear and a load_puzzle (),
+ * and solution counts have to be the same whether the transposition table
+ * is used or not
+ */
+int main (int argc, char **argv)
+{
+	int i, ncell;
+	uint64_t hash;
+	shape_t shape;
+	puzzle_rec_t rec, other;
+	journal_rec_t clear;
+	std::vector<move_t> moves;
+	Board b (nullptr), fresh (nullptr);
+
+	b.generate (1);
+	if (!check_hashes (b, "generate", 1))
+		return EXIT_FAILURE;
+	hash = b.get_user_hash ();
+
+	for (i = 0; i < NUM_MOVES; i++) {
+		move_t m;
+
+		do
+			ncell = next_rand () % 36;
+		while (b.is_immutable (ncell));
+
+		m.ncell = ncell;
+		m.shape = b.get_user_shape (ncell);
+		m.flags = b.get_user_guess (ncell).flags;
+		moves.push_back (m);
+		b.set_user_guess (ncell, (shape_t) (next_rand () % 3), m.flags);
+		if (!check_hashes (b, "move", i))
+			return EXIT_FAILURE;
+	}
+
+	for (i = NUM_MOVES - 1; i >= 0; i--) {
+		b.set_user_guess (moves[i].ncell, moves[i].shape, moves[i].flags);
+		if (!check_hashes (b, "undo", i))
+			return EXIT_FAILURE;
+	}
+	if (b.get_user_hash () != hash) {
+		fprintf (stderr, "undoing every move does not give the first hash back\n");
+		return EXIT_FAILURE;
+	}
+
+	// A clear, from a board with some shapes on it
+	for (i = 0; i < 36; i++) {
+		shape = (shape_t) (next_rand () % 2);
+		if (!b.is_immutable (i))
+			b.set_user_guess (i, shape, b.get_user_guess (i).flags);
+	}
+	memset (&clear, 0, sizeof (clear));
+	clear.type = JOURNAL_CLEAR;
+	if (!b.apply_journal_move (&clear) || !check_hashes (b, "clear", 0) || b.get_user_hash () != hash) {
+		fprintf (stderr, "a clear does not give the first hash back\n");
+		return EXIT_FAILURE;
+	}
+
+	// Another board loaded over a game in progress hashes as a fresh one
+	fresh.generate (2);
+	fresh.save_puzzle (&other);
+	b.set_user_guess (moves[0].ncell, SHAPE_MOON, moves[0].flags);
+	b.set_shape_status (moves[0].ncell, SHAPE_MOON);
+	if (!check_hashes (b, "set_shape_status", 0))
+		return EXIT_FAILURE;
+	b.load_puzzle (&other);
+	if (!check_hashes (b, "load_puzzle", 2) || b.get_user_hash () != fresh.get_user_hash () ||
+	    b.get_solution_hash () != fresh.get_solution_hash ()) {
+		fprintf (stderr, "load_puzzle () gives other hashes than generate ()\n");
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 * Generated puzzles, then the same with some givens dropped, so that
+	 * most of them have several solutions for the table to count
+	 */
+	for (i = 0; i < NUM_PUZZLES; i++) {
+		fresh.generate (100 + i);
+		fresh.save_puzzle (&rec);
+		if (!check_count (&rec, i))
+			return EXIT_FAILURE;
+
+		rec.immutable &= next_rand ();
+		if (!check_count (&rec, i))
+			return EXIT_FAILURE;
+	}
+
+	// No givens and no constraints: every grid
+	puzzle_clear (&rec);
+	if (!check_count (&rec, NUM_PUZZLES))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}